@@ -1,16 +1,74 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <iostream>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+// Wait-for graph that finds deadlocks as dependencies arrive instead of rescanning the
+// whole graph (Pearce-Kelly dynamic topological order).
+//
+// The acyclic part of the graph is kept in topological order. Inserting from -> to with
+// order[from] > order[to] only searches the window order[to]..order[from]: forward from
+// `to` and backward from `from`. If the forward search reaches `from`, the edge closes a
+// cycle. That edge is reported and parked in `blocked`, so the ordered part stays acyclic.
+// Otherwise the two visited sets swap places inside the window. Removing an edge never
+// invalidates the order. Each parked edge remembers the path that closed its cycle, so a
+// removal only retries the parked edges whose path used the removed edge.
 class WaitForGraph {
 
   public:
     explicit WaitForGraph(int processes)
-        : num_processes{processes}, adjacency_list(processes) {
+        : num_processes{processes}, adjacency_list(processes), reverse_list(processes),
+          order(processes), mark(processes, 0), parent(processes), stamp{0} {
+        for (int i{0}; i < processes; i++) {
+            order[i] = i;
+        }
     }
 
-    // Add an edge to the graph
-    void addDependency(int from, int to) {
-        adjacency_list[from].push_back(to);
+    // Add an edge to the graph; returns false when it closes a cycle, see deadlockCycle()
+    bool addDependency(int from, int to) {
+        if (!insertOrdered(from, to)) {
+            cycle = path;
+            park(from, to);
+            return false;
+        }
+        return true;
+    }
+
+    // Remove one copy of the edge, e.g. when a lock is granted or a waiter is aborted
+    void removeDependency(int from, int to) {
+        std::unordered_map<long long, std::vector<int>>::iterator copy{parked_slots.find(edgeKey(from, to))};
+        if (copy != parked_slots.end()) {
+            unpark(copy->second.back());
+            return;
+        }
+
+        if (!eraseOne(adjacency_list[from], to)) {
+            return;
+        }
+        eraseOne(reverse_list[to], from);
+
+        // Every other parked edge still has its path, so its cycle is still there
+        std::unordered_map<long long, std::vector<int>>::iterator it{watchers.find(edgeKey(from, to))};
+        if (it == watchers.end()) {
+            return;
+        }
+        std::vector<int> retry;
+        retry.swap(it->second);
+        watchers.erase(it);
+        for (int slot : retry) {
+            int waiter{blocked[slot].from};
+            int holder{blocked[slot].to};
+            unpark(slot);
+            if (!insertOrdered(waiter, holder)) {
+                park(waiter, holder);
+            }
+        }
     }
 
     // Print the adjacency list
@@ -21,47 +79,632 @@ class WaitForGraph {
             for (const int &neighbor : adjacency_list[i]) {
                 std::cout << "P" << neighbor << " ";
             }
+            for (const Parked &edge : blocked) {
+                if (edge.from == i) {
+                    std::cout << "P" << edge.to << " ";
+                }
+            }
             std::cout << std::endl;
         }
     }
 
-    // Detect cycle in the graph
-    bool detectDeadlock() {
-        std::vector<bool> visited(num_processes, false);
-        std::vector<bool> recursion_stack(num_processes, false);
+    // Every edge closing a cycle is parked, so the graph is deadlocked exactly when one is
+    bool detectDeadlock() const {
+        return parked_count > 0;
+    }
+
+    // Cycle closed by the last rejected addDependency: from, to, ..., back to from
+    const std::vector<int> &deadlockCycle() const {
+        return cycle;
+    }
+
+    // Every deadlocked group: a strongly connected component that contains a cycle, found by
+    // one iterative Tarjan pass over a CSR snapshot of all edges, parked ones included
+    std::vector<std::vector<int>> deadlockedComponents() const {
+        return components(snapshot());
+    }
+
+    // Processes to abort so that no deadlock is left, preferring cheap ones. Components are
+    // independent, so `threads` threads take them largest first.
+    //
+    // Within a component, the cheapest live process is aborted next. Whatever is then left
+    // with no live waiter or no live holder cannot be on a cycle and is dropped too. Aborts
+    // stop once the rest is acyclic: on a cycle of survivors, the first one dropped would
+    // still have had a live waiter and a live holder. Each process and edge is dropped once,
+    // so apart from sorting by cost this is O(processes + edges). A minimum-cost choice
+    // would be NP-hard; this is a heuristic.
+    std::vector<int> chooseVictims(const std::vector<long long> &cost, int threads) const {
+        Snapshot graph{snapshot()};
+        std::vector<std::vector<int>> groups{components(graph)};
+        std::sort(groups.begin(), groups.end(), [](const std::vector<int> &a, const std::vector<int> &b) {
+            return a.size() > b.size();
+        });
 
-        // Check each process
-        for (int process{0}; process < num_processes; process++) {
-            if (!visited[process] && dfs(process, visited, recursion_stack)) {
-                return true; // Deadlock detected
+        std::vector<int> group_of(num_processes, -1);
+        std::vector<int> local(num_processes);
+        for (size_t g{0}; g < groups.size(); g++) {
+            for (size_t i{0}; i < groups[g].size(); i++) {
+                group_of[groups[g][i]] = g;
+                local[groups[g][i]] = i;
             }
         }
-        return false; // No deadlock
+
+        std::vector<std::vector<int>> victims(groups.size());
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> pool;
+        for (int t{0}; t < std::max(1, threads); t++) {
+            pool.emplace_back([&]() {
+                for (size_t g{next++}; g < groups.size(); g = next++) {
+                    victims[g] = resolve(graph, groups[g], g, group_of, local, cost);
+                }
+            });
+        }
+        for (std::thread &t : pool) {
+            t.join();
+        }
+
+        std::vector<int> all;
+        for (const std::vector<int> &group : victims) {
+            all.insert(all.end(), group.begin(), group.end());
+        }
+        return all;
     }
 
   private:
-    // Depth-First Search for cycle detection
-    bool dfs(int process, std::vector<bool> &visited, std::vector<bool> &recursion_stack) {
-        visited[process] = true;
-        recursion_stack[process] = true;
+    struct Snapshot {
+        std::vector<int> offset;
+        std::vector<int> target;
+    };
+
+    // An edge that closed a cycle, with that cycle: from, to, ..., back to from. The edges
+    // after the first all lie in the ordered part. Free slots have from == -1.
+    struct Parked {
+        int from;
+        int to;
+        std::vector<int> cycle;
+    };
+
+    int num_processes;
+    std::vector<std::vector<int>> adjacency_list;
+    std::vector<std::vector<int>> reverse_list;
+    std::vector<Parked> blocked;
+    std::vector<int> free_slots;
+    int parked_count{0};
+    std::vector<int> cycle;
+
+    // Ordered edge -> parked slots whose cycle goes through it
+    std::unordered_map<long long, std::vector<int>> watchers;
+
+    // Parked edge -> slots holding a copy of it
+    std::unordered_map<long long, std::vector<int>> parked_slots;
+
+    // Topological position of every process in the ordered part
+    std::vector<int> order;
+
+    // Search scratch: forward visits are marked stamp, backward visits stamp + 1
+    std::vector<unsigned> mark;
+    std::vector<int> parent;
+    std::vector<int> stack;
+    std::vector<int> forward;
+    std::vector<int> backward;
+    std::vector<int> positions;
+    std::vector<int> path; // cycle found by the last failed insertOrdered
+    unsigned stamp;
 
-        // Explore neighbors
-        for (int neighbor : adjacency_list[process]) {
-            if (!visited[neighbor] && dfs(neighbor, visited, recursion_stack)) {
-                return true; // Deadlock detected
-            } else if (recursion_stack[neighbor]) {
-                return true; // Deadlock detected
+    static long long edgeKey(int from, int to) {
+        return static_cast<long long>(from) << 32 | static_cast<unsigned>(to);
+    }
+
+    // Parks from -> to with the cycle in `path` and watches every ordered edge on it
+    void park(int from, int to) {
+        int slot;
+        if (free_slots.empty()) {
+            slot = blocked.size();
+            blocked.push_back({});
+        } else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+        }
+        blocked[slot] = {from, to, path};
+        parked_count++;
+        parked_slots[edgeKey(from, to)].push_back(slot);
+
+        for (size_t i{1}; i < path.size(); i++) {
+            watchers[edgeKey(path[i], path[(i + 1) % path.size()])].push_back(slot);
+        }
+    }
+
+    void unpark(int slot) {
+        std::unordered_map<long long, std::vector<int>>::iterator copy{
+            parked_slots.find(edgeKey(blocked[slot].from, blocked[slot].to))};
+        if (eraseOne(copy->second, slot) && copy->second.empty()) {
+            parked_slots.erase(copy);
+        }
+
+        const std::vector<int> &ring{blocked[slot].cycle};
+        for (size_t i{1}; i < ring.size(); i++) {
+            std::unordered_map<long long, std::vector<int>>::iterator it{
+                watchers.find(edgeKey(ring[i], ring[(i + 1) % ring.size()]))};
+            if (it != watchers.end() && eraseOne(it->second, slot) && it->second.empty()) {
+                watchers.erase(it);
             }
         }
+        blocked[slot] = {-1, -1, {}};
+        free_slots.push_back(slot);
+        parked_count--;
+    }
 
-        recursion_stack[process] = false; // Backtrack
-        return false;                     // No cycle found
+    static bool eraseOne(std::vector<int> &list, int value) {
+        std::vector<int>::iterator it{std::find(list.begin(), list.end(), value)};
+        if (it == list.end()) {
+            return false;
+        }
+        *it = list.back();
+        list.pop_back();
+        return true;
     }
 
-    int num_processes;
-    std::vector<std::vector<int>> adjacency_list;
+    // All edges, ordered and parked, as one offset/target array
+    Snapshot snapshot() const {
+        Snapshot graph;
+        graph.offset.assign(num_processes + 1, 0);
+        for (int i{0}; i < num_processes; i++) {
+            graph.offset[i + 1] = adjacency_list[i].size();
+        }
+        for (const Parked &edge : blocked) {
+            if (edge.from != -1) {
+                graph.offset[edge.from + 1]++;
+            }
+        }
+        for (int i{0}; i < num_processes; i++) {
+            graph.offset[i + 1] += graph.offset[i];
+        }
+
+        graph.target.resize(graph.offset[num_processes]);
+        std::vector<int> cursor(graph.offset.begin(), graph.offset.end() - 1);
+        for (int i{0}; i < num_processes; i++) {
+            for (int neighbor : adjacency_list[i]) {
+                graph.target[cursor[i]++] = neighbor;
+            }
+        }
+        for (const Parked &edge : blocked) {
+            if (edge.from != -1) {
+                graph.target[cursor[edge.from]++] = edge.to;
+            }
+        }
+        return graph;
+    }
+
+    // Tarjan with an explicit call stack; keeps components of size > 1 and self-loops
+    static std::vector<std::vector<int>> components(const Snapshot &graph) {
+        int n{static_cast<int>(graph.offset.size()) - 1};
+        std::vector<int> index(n, -1);
+        std::vector<int> low(n);
+        std::vector<char> on_stack(n, 0);
+        std::vector<int> stack;
+        std::vector<std::pair<int, int>> call; // process, next edge to look at
+        std::vector<std::vector<int>> groups;
+        int counter{0};
+
+        for (int root{0}; root < n; root++) {
+            if (index[root] != -1) {
+                continue;
+            }
+            index[root] = low[root] = counter++;
+            stack.push_back(root);
+            on_stack[root] = 1;
+            call.push_back({root, graph.offset[root]});
+
+            while (!call.empty()) {
+                int process{call.back().first};
+                if (call.back().second < graph.offset[process + 1]) {
+                    int neighbor{graph.target[call.back().second++]};
+                    if (index[neighbor] == -1) {
+                        index[neighbor] = low[neighbor] = counter++;
+                        stack.push_back(neighbor);
+                        on_stack[neighbor] = 1;
+                        call.push_back({neighbor, graph.offset[neighbor]});
+                    } else if (on_stack[neighbor]) {
+                        low[process] = std::min(low[process], index[neighbor]);
+                    }
+                    continue;
+                }
+
+                call.pop_back();
+                if (!call.empty()) {
+                    low[call.back().first] = std::min(low[call.back().first], low[process]);
+                }
+                if (low[process] != index[process]) {
+                    continue;
+                }
+
+                std::vector<int> group;
+                int member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    on_stack[member] = 0;
+                    group.push_back(member);
+                } while (member != process);
+
+                bool self_loop{false};
+                for (int e{graph.offset[process]}; e < graph.offset[process + 1]; e++) {
+                    self_loop = self_loop || graph.target[e] == process;
+                }
+                if (group.size() > 1 || self_loop) {
+                    groups.push_back(group);
+                }
+            }
+        }
+        return groups;
+    }
+
+    // Victims for one component, see chooseVictims
+    static std::vector<int> resolve(const Snapshot &graph, const std::vector<int> &group, int id,
+                                    const std::vector<int> &group_of, const std::vector<int> &local,
+                                    const std::vector<long long> &cost) {
+        int size{static_cast<int>(group.size())};
+        std::vector<std::vector<int>> out(size);
+        std::vector<std::vector<int>> in(size);
+        for (int i{0}; i < size; i++) {
+            for (int e{graph.offset[group[i]]}; e < graph.offset[group[i] + 1]; e++) {
+                if (group_of[graph.target[e]] == id) {
+                    out[i].push_back(local[graph.target[e]]);
+                    in[local[graph.target[e]]].push_back(i);
+                }
+            }
+        }
+
+        std::vector<int> waits_on(size);
+        std::vector<int> waited_by(size);
+        for (int i{0}; i < size; i++) {
+            waits_on[i] = out[i].size();
+            waited_by[i] = in[i].size();
+        }
+
+        std::vector<int> by_cost(size);
+        for (int i{0}; i < size; i++) {
+            by_cost[i] = i;
+        }
+        std::sort(by_cost.begin(), by_cost.end(), [&](int a, int b) { return cost[group[a]] < cost[group[b]]; });
+
+        // Removing a process may leave others with no live waiter or no live holder; those
+        // are on no cycle any more and go too, each one once
+        std::vector<char> alive(size, 1);
+        std::vector<int> removed;
+        std::vector<int> victims;
+        for (int process : by_cost) {
+            if (!alive[process]) {
+                continue;
+            }
+            victims.push_back(group[process]);
+            alive[process] = 0;
+            removed.assign(1, process);
+            while (!removed.empty()) {
+                int gone{removed.back()};
+                removed.pop_back();
+                for (int holder : out[gone]) {
+                    if (alive[holder] && --waited_by[holder] == 0) {
+                        alive[holder] = 0;
+                        removed.push_back(holder);
+                    }
+                }
+                for (int waiter : in[gone]) {
+                    if (alive[waiter] && --waits_on[waiter] == 0) {
+                        alive[waiter] = 0;
+                        removed.push_back(waiter);
+                    }
+                }
+            }
+        }
+        return victims;
+    }
+
+    void newSearch() {
+        stamp += 2;
+        if (stamp < 2) {
+            std::fill(mark.begin(), mark.end(), 0);
+            stamp = 2;
+        }
+    }
+
+    // Adds from -> to to the ordered part unless it would close a cycle, which goes to `path`
+    bool insertOrdered(int from, int to) {
+        if (from == to) {
+            path.assign(1, from);
+            return false;
+        }
+
+        int lower{order[to]};
+        int upper{order[from]};
+        if (upper < lower) {
+            adjacency_list[from].push_back(to);
+            reverse_list[to].push_back(from);
+            return true;
+        }
+
+        newSearch();
+
+        // Forward from `to` over processes ordered before `from`; reaching `from` is a cycle
+        forward.clear();
+        stack.assign(1, to);
+        mark[to] = stamp;
+        parent[to] = -1;
+        while (!stack.empty()) {
+            int process{stack.back()};
+            stack.pop_back();
+            forward.push_back(process);
+
+            for (int neighbor : adjacency_list[process]) {
+                if (neighbor == from) {
+                    path.clear();
+                    for (int p{process}; p != -1; p = parent[p]) {
+                        path.push_back(p);
+                    }
+                    path.push_back(from);
+                    std::reverse(path.begin(), path.end());
+                    return false;
+                }
+                if (mark[neighbor] != stamp && order[neighbor] < upper) {
+                    mark[neighbor] = stamp;
+                    parent[neighbor] = process;
+                    stack.push_back(neighbor);
+                }
+            }
+        }
+
+        // Backward from `from` over processes ordered after `to`
+        backward.clear();
+        stack.assign(1, from);
+        mark[from] = stamp + 1;
+        while (!stack.empty()) {
+            int process{stack.back()};
+            stack.pop_back();
+            backward.push_back(process);
+
+            for (int waiter : reverse_list[process]) {
+                if (mark[waiter] != stamp + 1 && order[waiter] > lower) {
+                    mark[waiter] = stamp + 1;
+                    stack.push_back(waiter);
+                }
+            }
+        }
+
+        // Reuse the positions both sets held: everything reaching `from` goes first
+        std::sort(forward.begin(), forward.end(), [&](int a, int b) { return order[a] < order[b]; });
+        std::sort(backward.begin(), backward.end(), [&](int a, int b) { return order[a] < order[b]; });
+        positions.clear();
+        for (int process : backward) {
+            positions.push_back(order[process]);
+        }
+        for (int process : forward) {
+            positions.push_back(order[process]);
+        }
+        std::sort(positions.begin(), positions.end());
+
+        size_t next{0};
+        for (int process : backward) {
+            order[process] = positions[next++];
+        }
+        for (int process : forward) {
+            order[process] = positions[next++];
+        }
+
+        adjacency_list[from].push_back(to);
+        reverse_list[to].push_back(from);
+        return true;
+    }
 };
 
+// The old approach: a full DFS over every process, iterative so large graphs fit the stack
+bool fullScanDeadlock(const std::vector<std::vector<int>> &adjacency_list) {
+    int n{static_cast<int>(adjacency_list.size())};
+    std::vector<char> state(n, 0); // 0 unvisited, 1 on the DFS path, 2 finished
+    std::vector<std::pair<int, size_t>> stack;
+
+    for (int root{0}; root < n; root++) {
+        if (state[root] != 0) {
+            continue;
+        }
+        state[root] = 1;
+        stack.push_back({root, 0});
+        while (!stack.empty()) {
+            std::pair<int, size_t> &top{stack.back()};
+            if (top.second == adjacency_list[top.first].size()) {
+                state[top.first] = 2;
+                stack.pop_back();
+                continue;
+            }
+
+            int neighbor{adjacency_list[top.first][top.second++]};
+            if (state[neighbor] == 1) {
+                return true;
+            }
+            if (state[neighbor] == 0) {
+                state[neighbor] = 1;
+                stack.push_back({neighbor, 0});
+            }
+        }
+    }
+    return false;
+}
+
+// Random lock traffic: waits appear and get released while about `live` are outstanding.
+// A request that closes a cycle stays parked until more than `parked` are waiting, then the
+// oldest one is aborted. For the last `checked` updates a plain adjacency list of every
+// edge follows along and is rescanned in full after each update; both must report a
+// deadlock after exactly the same updates.
+void benchmark(int processes, int updates, int live, int parked, int checked) {
+    std::mt19937 rng(7);
+    WaitForGraph wfg{processes};
+    std::vector<std::pair<int, int>> edges;
+    std::deque<std::pair<int, int>> waiting; // rejected requests, oldest first
+    std::vector<std::vector<int>> adjacency_list(processes);
+    std::vector<int> incremental;
+    std::vector<int> full_scan;
+    long long deadlocks{0};
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    for (int step{0}; step < updates; step++) {
+        bool baseline{step >= updates - checked};
+        if (step == updates - checked) {
+            if (step > 0) {
+                std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+                std::cout << "Incremental: " << step << " updates, " << deadlocks << " deadlocks, "
+                          << elapsed.count() * 1e9 / step << " ns/update" << std::endl;
+            }
+
+            for (const std::pair<int, int> &edge : edges) {
+                adjacency_list[edge.first].push_back(edge.second);
+            }
+            for (const std::pair<int, int> &edge : waiting) {
+                adjacency_list[edge.first].push_back(edge.second);
+            }
+            deadlocks = 0;
+            start = std::chrono::steady_clock::now();
+        }
+
+        if (edges.size() < static_cast<size_t>(live) || rng() % 2 == 0) {
+            int from{static_cast<int>(rng() % processes)};
+            int to{static_cast<int>(rng() % processes)};
+            if (wfg.addDependency(from, to)) {
+                edges.push_back({from, to});
+            } else {
+                deadlocks++;
+                waiting.push_back({from, to});
+            }
+            if (baseline) {
+                adjacency_list[from].push_back(to);
+            }
+        } else {
+            size_t j{rng() % edges.size()};
+            wfg.removeDependency(edges[j].first, edges[j].second);
+            if (baseline) {
+                std::vector<int> &list{adjacency_list[edges[j].first]};
+                list.erase(std::find(list.begin(), list.end(), edges[j].second));
+            }
+            edges[j] = edges.back();
+            edges.pop_back();
+        }
+
+        if (baseline) {
+            if (wfg.detectDeadlock()) {
+                incremental.push_back(step);
+            }
+            if (fullScanDeadlock(adjacency_list)) {
+                full_scan.push_back(step);
+            }
+        }
+
+        if (waiting.size() > static_cast<size_t>(parked)) {
+            wfg.removeDependency(waiting.front().first, waiting.front().second);
+            if (baseline) {
+                std::vector<int> &list{adjacency_list[waiting.front().first]};
+                list.erase(std::find(list.begin(), list.end(), waiting.front().second));
+            }
+            waiting.pop_front();
+        }
+    }
+
+    std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+    if (checked == 0) {
+        std::cout << "Incremental: " << updates << " updates, " << deadlocks << " deadlocks, "
+                  << elapsed.count() * 1e9 / updates << " ns/update" << std::endl;
+        return;
+    }
+    std::cout << "Full scan: " << checked << " updates, " << deadlocks << " deadlocks, deadlocked after "
+              << full_scan.size() << " of them, " << elapsed.count() * 1e9 / checked << " ns/update ("
+              << (incremental == full_scan ? "matches" : "MISMATCH") << ")" << std::endl;
+}
+
+// Many requests parked on small two-process cycles, then add/remove traffic elsewhere in
+// the graph. None of it touches the parked cycles, so none of it should retry them.
+void parkedBenchmark(int processes, int parked, int updates) {
+    std::mt19937 rng(8);
+    WaitForGraph wfg{processes};
+    for (int j{0}; j < parked; j++) {
+        wfg.addDependency(2 * j, 2 * j + 1);
+        wfg.addDependency(2 * j + 1, 2 * j);
+    }
+
+    int first{2 * parked};
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    for (int step{0}; step < updates; step++) {
+        int from{first + static_cast<int>(rng() % (processes - first))};
+        int to{first + static_cast<int>(rng() % (processes - first))};
+        if (wfg.addDependency(from, to)) {
+            wfg.removeDependency(from, to);
+        }
+    }
+    std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+    std::cout << parked << " parked requests, " << processes << " processes: " << elapsed.count() * 1e9 / updates
+              << " ns per add + remove (" << (wfg.detectDeadlock() ? "still deadlocked" : "DEADLOCK LOST") << ")"
+              << std::endl;
+}
+
+// One sweep over a wait-for graph full of deadlocks: find every deadlocked component, pick
+// victims on one thread and on all cores, and check that aborting them leaves no cycle.
+// Processes come in clusters of `cluster` that wait on each other about twice over, so
+// nearly every cluster is one big deadlock; one wait in eight goes to a later cluster.
+void sweepBenchmark(int processes, int dependencies, int cluster) {
+    std::mt19937 rng(9);
+    WaitForGraph wfg{processes};
+    std::vector<std::vector<int>> adjacency_list(processes);
+    for (int j{0}; j < dependencies; j++) {
+        int from{static_cast<int>(rng() % processes)};
+        int base{from / cluster * cluster};
+        int to{base + static_cast<int>(rng() % std::min(cluster, processes - base))};
+        if (rng() % 8 == 0) {
+            to = base + static_cast<int>(rng() % (processes - base));
+        }
+        wfg.addDependency(from, to);
+        adjacency_list[from].push_back(to);
+    }
+
+    std::vector<long long> cost(processes);
+    for (long long &c : cost) {
+        c = 1 + rng() % 1000;
+    }
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    std::vector<std::vector<int>> groups{wfg.deadlockedComponents()};
+    std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() - start};
+    size_t deadlocked{0};
+    size_t largest{0};
+    for (const std::vector<int> &group : groups) {
+        deadlocked += group.size();
+        largest = std::max(largest, group.size());
+    }
+    std::cout << processes << " processes, " << dependencies << " dependencies: " << groups.size()
+              << " deadlocked components, " << deadlocked << " processes, largest " << largest
+              << " (" << elapsed.count() << " ms)" << std::endl;
+
+    int cores{static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+    for (int threads : {1, cores}) {
+        start = std::chrono::steady_clock::now();
+        std::vector<int> victims{wfg.chooseVictims(cost, threads)};
+        elapsed = std::chrono::steady_clock::now() - start;
+
+        std::vector<char> aborted(processes, 0);
+        long long total{0};
+        for (int victim : victims) {
+            aborted[victim] = 1;
+            total += cost[victim];
+        }
+        std::vector<std::vector<int>> survivors(processes);
+        for (int from{0}; from < processes; from++) {
+            for (int to : adjacency_list[from]) {
+                if (!aborted[from] && !aborted[to]) {
+                    survivors[from].push_back(to);
+                }
+            }
+        }
+        std::cout << "Victims (" << threads << " threads): " << victims.size() << ", cost " << total << ", "
+                  << elapsed.count() << " ms, " << (fullScanDeadlock(survivors) ? "DEADLOCK LEFT" : "no deadlock left")
+                  << std::endl;
+    }
+}
+
 int main(void) {
     // Step 1: Create Wait-For Graph
     WaitForGraph wfg{5};
@@ -71,7 +714,7 @@ int main(void) {
     wfg.addDependency(1, 2); // P1 → P2
     wfg.addDependency(2, 3); // P2 → P3
     wfg.addDependency(3, 4); // P3 → P4
-    wfg.addDependency(4, 0); // P3 → P4 (Cycle)
+    wfg.addDependency(4, 0); // P4 → P0 (Cycle)
 
     // Step 3: Print the Wait-For Graph
     wfg.printGraph();
@@ -79,7 +722,47 @@ int main(void) {
     // Step 4: Detect deadlock
     if (wfg.detectDeadlock()) {
         std::cout << "Deadlock detected in the system!" << std::endl;
+        std::cout << "Cycle: ";
+        for (int process : wfg.deadlockCycle()) {
+            std::cout << "P" << process << " → ";
+        }
+        std::cout << "P" << wfg.deadlockCycle().front() << std::endl;
     } else {
         std::cout << "No deadlock detected in the system." << std::endl;
     }
+
+    // Step 5: Abort P4's request and check again
+    wfg.removeDependency(4, 0);
+    std::cout << "After aborting P4 → P0: " << (wfg.detectDeadlock() ? "deadlock" : "no deadlock") << std::endl;
+
+    // Step 6: Two independent deadlocks, resolved in one sweep by aborting the cheapest
+    WaitForGraph lockManager{7};
+    std::vector<long long> cost{5, 1, 7, 4, 9, 2, 3};
+    lockManager.addDependency(0, 1); // P0 → P1
+    lockManager.addDependency(1, 2); // P1 → P2
+    lockManager.addDependency(2, 0); // P2 → P0 (Cycle)
+    lockManager.addDependency(3, 4); // P3 → P4
+    lockManager.addDependency(4, 3); // P4 → P3 (Cycle)
+    lockManager.addDependency(5, 6); // P5 → P6
+    for (const std::vector<int> &group : lockManager.deadlockedComponents()) {
+        std::cout << "Deadlocked:";
+        for (int process : group) {
+            std::cout << " P" << process;
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "Abort:";
+    for (int process : lockManager.chooseVictims(cost, 2)) {
+        std::cout << " P" << process << " (cost " << cost[process] << ")";
+    }
+    std::cout << std::endl;
+
+    std::cout << std::endl;
+    benchmark(100000, 4000000, 90000, 0, 0);
+    benchmark(1000, 50000, 1000, 1, 50000);
+    parkedBenchmark(400000, 2000, 100000);
+    parkedBenchmark(400000, 50000, 100000);
+    parkedBenchmark(400000, 150000, 100000);
+    sweepBenchmark(500000, 1000000, 50);
+    sweepBenchmark(500000, 1000000, 5000);
 }
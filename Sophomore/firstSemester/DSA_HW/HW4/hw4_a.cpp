@@ -1,27 +1,149 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <list>
 #include <queue>
+#include <random>
 #include <stack>
+#include <string>
 #include <vector>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Square 0/1 matrix with 64 columns packed per word. Rows are padded to a multiple of
+// four words so the AVX2 kernels below always work on whole 256-bit lanes.
+class BitMatrix {
+  public:
+    BitMatrix();
+    void Resize(int n);
+    int Size() const;
+    int Words() const;
+    void Set(int i, int j);
+    bool Test(int i, int j) const;
+    uint64_t *Row(int i);
+    const uint64_t *Row(int i) const;
+
+  private:
+    int size;
+    int capacity;
+    int stride;
+    std::vector<uint64_t> bits;
+};
+
+BitMatrix::BitMatrix() : size(0), capacity(0), stride(0) {}
+
+// InsertEdge sizes the matrix to the vertex count before the first edge; a later call
+// keeps the rows already set
+void BitMatrix::Resize(int n) {
+    if (n > capacity) {
+        int grown{std::max(n, capacity * 2)};
+        int grownStride{(grown + 255) / 256 * 4};
+        std::vector<uint64_t> copy(static_cast<size_t>(grown) * grownStride, 0);
+        for (int i{0}; i < size; i++) {
+            std::copy(bits.begin() + static_cast<size_t>(i) * stride, bits.begin() + static_cast<size_t>(i) * stride + stride,
+                      copy.begin() + static_cast<size_t>(i) * grownStride);
+        }
+        bits.swap(copy);
+        capacity = grown;
+        stride = grownStride;
+    }
+    size = std::max(size, n);
+}
+
+int BitMatrix::Size() const {
+    return size;
+}
+
+int BitMatrix::Words() const {
+    return stride;
+}
+
+void BitMatrix::Set(int i, int j) {
+    Row(i)[j >> 6] |= uint64_t{1} << (j & 63);
+}
+
+bool BitMatrix::Test(int i, int j) const {
+    return (Row(i)[j >> 6] >> (j & 63)) & 1;
+}
+
+uint64_t *BitMatrix::Row(int i) {
+    return bits.data() + static_cast<size_t>(i) * stride;
+}
+
+const uint64_t *BitMatrix::Row(int i) const {
+    return bits.data() + static_cast<size_t>(i) * stride;
+}
+
+// dst |= src & ~mask, `words` is a multiple of 4
+void OrAndNot(uint64_t *dst, const uint64_t *src, const uint64_t *mask, int words) {
+#ifdef __AVX2__
+    for (int k{0}; k < words; k += 4) {
+        __m256i s{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + k))};
+        __m256i m{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(mask + k))};
+        __m256i d{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + k))};
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + k), _mm256_or_si256(d, _mm256_andnot_si256(m, s)));
+    }
+#else
+    for (int k{0}; k < words; k++) {
+        dst[k] |= src[k] & ~mask[k];
+    }
+#endif
+}
+
+// popcount(a & b), `words` is a multiple of 4. The AVX2 path counts bits per nibble with
+// a shuffle lookup and sums the bytes of each 64-bit lane with SAD.
+long long AndCount(const uint64_t *a, const uint64_t *b, int words) {
+#ifdef __AVX2__
+    const __m256i lookup{_mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4)};
+    const __m256i low{_mm256_set1_epi8(0x0f)};
+    __m256i total{_mm256_setzero_si256()};
+    for (int k{0}; k < words; k += 4) {
+        __m256i x{_mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + k)),
+                                   _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + k)))};
+        __m256i count{_mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(x, low)),
+                                      _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), low)))};
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(count, _mm256_setzero_si256()));
+    }
+    return _mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1) + _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3);
+#else
+    long long total{0};
+    for (int k{0}; k < words; k++) {
+        total += __builtin_popcountll(a[k] & b[k]);
+    }
+    return total;
+#endif
+}
+
 class Graph {
   public:
+    // Weighted edge stored inline in the adjacency list
+    struct Arc {
+        int32_t v;
+        int32_t w;
+    };
+
     Graph();
     void InsertVertex(int v);
     void InsertEdge(int u, int v, int weight = 1);
     bool IsEmpty();
-    std::list<std::vector<int>> Adjacent_List(int u);
+    const std::vector<Arc> &Adjacent_List(int u);
     void PrintAdjacentMatrix();
     void PrintAdjacentList();
     void BFS(int start_vertex);
     void DFS(int start_vertex);
+    std::vector<int> BFSLevels(int start_vertex);
+    long long TriangleCount();
 
   private:
     int NumberVecterxs;
     int NumberEdges;
     std::list<int> vertexs;
-    std::vector<std::vector<int>> adjacent_matrix;
-    std::vector<std::list<std::vector<int>>> adjacent_list;
+    BitMatrix adjacent_bits;
+    std::vector<std::vector<Arc>> adjacent_list;
 };
 
 Graph::Graph() {
@@ -32,7 +154,7 @@ bool Graph::IsEmpty() {
     return (vertexs.size() == 0);
 }
 
-std::list<std::vector<int>> Graph::Adjacent_List(int i) {
+const std::vector<Graph::Arc> &Graph::Adjacent_List(int i) {
     return adjacent_list[i];
 }
 
@@ -42,33 +164,38 @@ void Graph::InsertVertex(int v) {
 }
 
 void Graph::InsertEdge(int u, int v, int weight) {
-    if (adjacent_matrix.size() == 0) {
-        for (int i{0}; i < vertexs.size(); i++)
-            adjacent_matrix.push_back(std::vector<int>(vertexs.size()));
+    if (adjacent_bits.Size() == 0) {
+        adjacent_bits.Resize(vertexs.size());
     }
 
     if (adjacent_list.size() == 0) {
-        for (int i{0}; i < vertexs.size(); i++)
-            adjacent_list.push_back(std::list<std::vector<int>>());
+        adjacent_list.resize(vertexs.size());
     }
 
-    adjacent_matrix[u][v] = weight;
+    adjacent_bits.Set(u, v);
     adjacent_list[u].push_back({v, weight});
+    NumberEdges++;
 }
 
 void Graph::PrintAdjacentMatrix() {
-    for (int i{0}; i < vertexs.size(); i++) {
+    std::vector<int> weight(vertexs.size());
+    for (int i{0}; i < adjacent_bits.Size(); i++) {
+        // A repeated edge keeps the weight it was inserted with last
+        for (Arc &it : adjacent_list[i]) {
+            weight[it.v] = it.w;
+        }
+
         for (int j{0}; j < vertexs.size(); j++) {
-            if (adjacent_matrix[i][j])
-                std::cout << "(" << i << ", " << j << ", " << adjacent_matrix[i][j] << ")" << std::endl;
+            if (adjacent_bits.Test(i, j) && weight[j])
+                std::cout << "(" << i << ", " << j << ", " << weight[j] << ")" << std::endl;
         }
     }
 }
 
 void Graph::PrintAdjacentList() {
-    for (int i{0}; i < vertexs.size(); i++) {
-        for (std::vector<int> &it : adjacent_list[i]) {
-            std::cout << "(" << i << ", " << it[0] << ", " << it[1] << ")" << std::endl;
+    for (int i{0}; i < adjacent_list.size(); i++) {
+        for (Arc &it : adjacent_list[i]) {
+            std::cout << "(" << i << ", " << it.v << ", " << it.w << ")" << std::endl;
         }
     }
 }
@@ -85,10 +212,10 @@ void Graph::BFS(int start_vertex) {
         std::cout << v << std::endl;
         q.pop();
 
-        for (std::vector<int> &it : adjacent_list[v]) {
-            if (!visited[it[0]]) {
-                visited[it[0]] = true;
-                q.push(it[0]);
+        for (Arc &it : adjacent_list[v]) {
+            if (!visited[it.v]) {
+                visited[it.v] = true;
+                q.push(it.v);
             }
         }
     }
@@ -109,18 +236,179 @@ void Graph::DFS(int start_vertex) {
             std::cout << v << std::endl;
         }
 
-        std::list<std::vector<int>> &adj = adjacent_list[v];
-        std::vector<std::vector<int>> reversed_adj{adj.rbegin(), adj.rend()};
+        std::vector<Arc> &adj = adjacent_list[v];
+        for (std::vector<Arc>::reverse_iterator neighbor{adj.rbegin()}; neighbor != adj.rend(); neighbor++) {
+            if (!visited[neighbor->v]) {
+                s.push(neighbor->v);
+            }
+        }
+    }
+}
+
+// Level-synchronous BFS on the bit matrix: each frontier vertex ORs its row, minus the
+// visited set, into the next frontier 256 bits at a time. Unreached vertices get -1.
+std::vector<int> Graph::BFSLevels(int start_vertex) {
+    std::vector<int> level(NumberVecterxs, -1);
+    if (adjacent_bits.Size() == 0) {
+        level[start_vertex] = 0;
+        return level;
+    }
+
+    int words{adjacent_bits.Words()};
+    std::vector<uint64_t> visited(words, 0);
+    std::vector<uint64_t> frontier(words, 0);
+    std::vector<uint64_t> next(words, 0);
+
+    level[start_vertex] = 0;
+    visited[start_vertex >> 6] |= uint64_t{1} << (start_vertex & 63);
+    frontier[start_vertex >> 6] |= uint64_t{1} << (start_vertex & 63);
+
+    for (int depth{1}, found{1}; found > 0; depth++) {
+        std::fill(next.begin(), next.end(), 0);
+        for (int k{0}; k < words; k++) {
+            for (uint64_t word{frontier[k]}; word != 0; word &= word - 1) {
+                int u{k * 64 + __builtin_ctzll(word)};
+                OrAndNot(next.data(), adjacent_bits.Row(u), visited.data(), words);
+            }
+        }
+
+        found = 0;
+        for (int k{0}; k < words; k++) {
+            visited[k] |= next[k];
+            for (uint64_t word{next[k]}; word != 0; word &= word - 1) {
+                level[k * 64 + __builtin_ctzll(word)] = depth;
+                found++;
+            }
+        }
+        frontier.swap(next);
+    }
+    return level;
+}
+
+// Triangles of the underlying undirected simple graph. Every edge u < v adds
+// |N(u) & N(v)|, which counts each triangle once per side.
+long long Graph::TriangleCount() {
+    BitMatrix undirected;
+    undirected.Resize(adjacent_bits.Size());
+    for (int u{0}; u < static_cast<int>(adjacent_list.size()); u++) {
+        for (Arc &it : adjacent_list[u]) {
+            if (it.v != u) {
+                undirected.Set(u, it.v);
+                undirected.Set(it.v, u);
+            }
+        }
+    }
+
+    long long total{0};
+    int words{undirected.Words()};
+    for (int u{0}; u < undirected.Size(); u++) {
+        const uint64_t *row{undirected.Row(u)};
+        for (int k{(u + 1) >> 6}; k < words; k++) {
+            uint64_t word{row[k]};
+            if (k == (u + 1) >> 6) {
+                word &= ~uint64_t{0} << ((u + 1) & 63);
+            }
+
+            for (; word != 0; word &= word - 1) {
+                int v{k * 64 + __builtin_ctzll(word)};
+                total += AndCount(row, undirected.Row(v), words);
+            }
+        }
+    }
+    return total / 3;
+}
+
+double ElapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Random directed graph with n vertices and about n * degree edges. Times the bit matrix
+// kernels and checks them against a queue BFS over the adjacency lists and a sorted
+// merge of undirected neighbour lists.
+void KernelBenchmark(int n, int degree) {
+    std::mt19937 rng(37);
+    Graph g;
+    for (int i{0}; i < n; i++) {
+        g.InsertVertex(i);
+    }
+    for (long long j{0}; j < static_cast<long long>(n) * degree; j++) {
+        g.InsertEdge(rng() % n, rng() % n);
+    }
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    std::vector<int> level{g.BFSLevels(0)};
+    double bfsTime{ElapsedSince(start)};
+
+    std::vector<int> expected(n, -1);
+    std::queue<int> q;
+    expected[0] = 0;
+    q.push(0);
+    while (!q.empty()) {
+        int u{q.front()};
+        q.pop();
+        for (const Graph::Arc &it : g.Adjacent_List(u)) {
+            if (expected[it.v] == -1) {
+                expected[it.v] = expected[u] + 1;
+                q.push(it.v);
+            }
+        }
+    }
+
+    start = std::chrono::steady_clock::now();
+    long long triangles{g.TriangleCount()};
+    double triangleTime{ElapsedSince(start)};
 
-        for (std::vector<int> &neighbor : reversed_adj) {
-            if (!visited[neighbor[0]]) {
-                s.push(neighbor[0]);
+    start = std::chrono::steady_clock::now();
+    std::vector<std::vector<int>> neighbours(n);
+    for (int u{0}; u < n; u++) {
+        for (const Graph::Arc &it : g.Adjacent_List(u)) {
+            if (it.v != u) {
+                neighbours[u].push_back(it.v);
+                neighbours[it.v].push_back(u);
+            }
+        }
+    }
+    for (std::vector<int> &list : neighbours) {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+    long long mergeTriangles{0};
+    for (int u{0}; u < n; u++) {
+        for (int v : neighbours[u]) {
+            if (v <= u) {
+                continue;
+            }
+            // Common neighbours w > v, so each triangle u < v < w is counted once
+            std::vector<int>::const_iterator a{std::upper_bound(neighbours[u].begin(), neighbours[u].end(), v)};
+            std::vector<int>::const_iterator b{std::upper_bound(neighbours[v].begin(), neighbours[v].end(), v)};
+            while (a != neighbours[u].end() && b != neighbours[v].end()) {
+                if (*a < *b) {
+                    a++;
+                } else if (*b < *a) {
+                    b++;
+                } else {
+                    mergeTriangles++;
+                    a++;
+                    b++;
+                }
             }
         }
     }
+    double mergeTime{ElapsedSince(start)};
+
+    int reached{static_cast<int>(std::count_if(level.begin(), level.end(), [](int l) { return l >= 0; }))};
+    std::cout << n << " vertices, " << static_cast<long long>(n) * degree << " edges" << std::endl;
+    std::cout << "BFSLevels: " << bfsTime << " ms, " << reached << " reached, matches queue BFS: " << (level == expected ? "yes" : "no") << std::endl;
+    std::cout << "TriangleCount: " << triangleTime << " ms, " << triangles << " triangles; sorted merge: " << mergeTime << " ms, "
+              << (triangles == mergeTriangles ? "same" : "DIFFERENT") << std::endl;
 }
 
-int main(void) {
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "kernels") {
+        KernelBenchmark(argc > 2 ? std::atoi(argv[2]) : 4096, argc > 3 ? std::atoi(argv[3]) : 64);
+        return 0;
+    }
+
     int u, v;
     int weight;
     int N;
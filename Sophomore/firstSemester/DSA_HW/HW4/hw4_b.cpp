@@ -1,15 +1,167 @@
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <list>
+#include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
+// Which vertex pairs the Kruskal input connects, one bit per pair. GetEdges walks the set
+// bits above the diagonal, so each undirected edge is listed once without an N^2 scan.
+class BitMatrix {
+  public:
+    BitMatrix();
+    void Resize(int n);
+    int Size() const;
+    void Set(int i, int j);
+    bool Test(int i, int j) const;
+    const uint64_t *Row(int i) const;
+
+  private:
+    int size;
+    int capacity;
+    int stride;
+    std::vector<uint64_t> bits;
+};
+
+BitMatrix::BitMatrix() : size(0), capacity(0), stride(0) {}
+
+// The OJ input names vertices in any order, so the matrix grows edge by edge; rows already
+// filled are copied into the wider layout
+void BitMatrix::Resize(int n) {
+    if (n > capacity) {
+        int grown{std::max(n, capacity * 2)};
+        int grownStride{(grown + 63) / 64};
+        std::vector<uint64_t> copy(static_cast<size_t>(grown) * grownStride, 0);
+        for (int i{0}; i < size; i++) {
+            std::copy(bits.begin() + static_cast<size_t>(i) * stride, bits.begin() + static_cast<size_t>(i) * stride + stride,
+                      copy.begin() + static_cast<size_t>(i) * grownStride);
+        }
+        bits.swap(copy);
+        capacity = grown;
+        stride = grownStride;
+    }
+    size = std::max(size, n);
+}
+
+int BitMatrix::Size() const {
+    return size;
+}
+
+void BitMatrix::Set(int i, int j) {
+    bits[static_cast<size_t>(i) * stride + (j >> 6)] |= uint64_t{1} << (j & 63);
+}
+
+bool BitMatrix::Test(int i, int j) const {
+    return (Row(i)[j >> 6] >> (j & 63)) & 1;
+}
+
+const uint64_t *BitMatrix::Row(int i) const {
+    return bits.data() + static_cast<size_t>(i) * stride;
+}
+
+// Runs task(begin, end) on `threads` contiguous slices of [0, n), inline when threads is 1
+template <class Task>
+void ParallelChunks(size_t n, int threads, Task task) {
+    if (threads <= 1 || n < 2) {
+        task(size_t{0}, n);
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    size_t chunk{(n + threads - 1) / threads};
+    for (size_t begin{0}; begin < n; begin += chunk) {
+        pool.emplace_back(task, begin, std::min(n, begin + chunk));
+    }
+    for (std::thread &t : pool) {
+        t.join();
+    }
+}
+
+// Union by rank with iterative path halving
+class DisjointSets {
+  public:
+    explicit DisjointSets(int n = 0);
+    int Find(int vertex);
+    int Root(int vertex) const;
+    bool Union(int u, int v);
+
+  private:
+    std::vector<int> parent;
+    std::vector<uint8_t> rank;
+};
+
+DisjointSets::DisjointSets(int n) : parent(n), rank(n, 0) {
+    for (int i{0}; i < n; i++) {
+        parent[i] = i;
+    }
+}
+
+// Points every other vertex on the way at its grandparent
+int DisjointSets::Find(int vertex) {
+    while (parent[vertex] != vertex) {
+        parent[vertex] = parent[parent[vertex]];
+        vertex = parent[vertex];
+    }
+    return vertex;
+}
+
+// Same as Find but without writes, so several threads may call it at once
+int DisjointSets::Root(int vertex) const {
+    while (parent[vertex] != vertex) {
+        vertex = parent[vertex];
+    }
+    return vertex;
+}
+
+// Returns false when u and v were already in one set
+bool DisjointSets::Union(int u, int v) {
+    int root_u{Find(u)};
+    int root_v{Find(v)};
+    if (root_u == root_v) {
+        return false;
+    }
+
+    if (rank[root_u] < rank[root_v]) {
+        parent[root_u] = root_v;
+    } else if (rank[root_u] > rank[root_v]) {
+        parent[root_v] = root_u;
+    } else {
+        parent[root_v] = root_u;
+        rank[root_u]++;
+    }
+    return true;
+}
+
 class Graph {
   public:
+    // Weighted edge stored inline in the adjacency list
+    struct Arc {
+        int32_t v;
+        int32_t w;
+    };
+
+    // Ties are broken by endpoints so the minimum spanning tree is unique
+    struct Edge {
+        int u;
+        int v;
+        int weight;
+        bool operator<(const Edge &other) const {
+            if (weight != other.weight) {
+                return weight < other.weight;
+            }
+            return u != other.u ? u < other.u : v < other.v;
+        }
+    };
+
     Graph();
     void InsertVertex(int v);
     void InsertEdge(int u, int v, int weight = 1);
     bool IsEmpty();
-    std::list<std::vector<int>> Adjacent_List(int u);
+    const std::vector<Arc> &Adjacent_List(int u);
     void PrintAdjacentMatrix();
     void PrintAdjacentList();
     void KruskalMST();
@@ -18,21 +170,37 @@ class Graph {
     int NumberVertices;
     int NumberEdges;
     std::list<int> vertices;
-    std::vector<std::vector<int>> adjacent_matrix;
-    std::vector<std::list<std::vector<int>>> adjacent_list;
-
-    struct Edge {
-        int u;
-        int v;
-        int weight;
-        bool operator<(const Edge &other) const {
-            return weight < other.weight;
-        }
-    };
+    BitMatrix adjacent_bits;
+    std::vector<std::vector<Arc>> adjacent_list;
 
     std::vector<Edge> GetEdges();
-    int Find(std::vector<int> &parent, int vertex);
-    void Union(std::vector<int> &parent, std::vector<int> &rank, int u, int v);
+};
+
+// Filter-Kruskal: split the edges around a sampled pivot and solve the light side first.
+// Heavy edges whose ends the light side already connected are then filtered out, so most
+// of them are never sorted. Splits and filters run on `threads` threads. Ranges of at most
+// BASE_CASE edges are sorted and scanned like plain Kruskal. Edges come out in ascending
+// order, the same tree and order a full sort would give.
+class FilterKruskal {
+  public:
+    explicit FilterKruskal(int n, int threads = 0);
+    std::vector<Graph::Edge> Run(std::vector<Graph::Edge> &edges);
+
+  private:
+    static constexpr size_t BASE_CASE{1 << 16};
+
+    int threads;
+    int components;
+    DisjointSets sets;
+    std::mt19937 rng;
+    std::vector<Graph::Edge> *edges;
+    std::vector<Graph::Edge> scratch;
+    std::vector<Graph::Edge> tree;
+
+    void Solve(size_t lo, size_t hi);
+    void Kruskal(size_t lo, size_t hi);
+    template <class Keep>
+    size_t Split(size_t lo, size_t hi, Keep keep);
 };
 
 Graph::Graph() {
@@ -43,7 +211,7 @@ bool Graph::IsEmpty() {
     return (vertices.size() == 0);
 }
 
-std::list<std::vector<int>> Graph::Adjacent_List(int i) {
+const std::vector<Graph::Arc> &Graph::Adjacent_List(int i) {
     return adjacent_list[i];
 }
 
@@ -55,9 +223,8 @@ void Graph::InsertVertex(int v) {
 }
 
 void Graph::InsertEdge(int u, int v, int weight) {
-    if (adjacent_matrix.size() <= u || adjacent_matrix.size() <= v) {
-        int max_size = std::max(u, v) + 1;
-        adjacent_matrix.resize(max_size, std::vector<int>(max_size, 0));
+    if (adjacent_bits.Size() <= u || adjacent_bits.Size() <= v) {
+        adjacent_bits.Resize(std::max(u, v) + 1);
     }
 
     if (adjacent_list.size() <= u || adjacent_list.size() <= v) {
@@ -65,63 +232,155 @@ void Graph::InsertEdge(int u, int v, int weight) {
         adjacent_list.resize(max_size);
     }
 
-    adjacent_matrix[u][v] = weight;
-    adjacent_matrix[v][u] = weight;
+    adjacent_bits.Set(u, v);
+    adjacent_bits.Set(v, u);
     adjacent_list[u].push_back({v, weight});
     adjacent_list[v].push_back({u, weight});
 }
 
 std::vector<Graph::Edge> Graph::GetEdges() {
     std::vector<Edge> edges;
-    for (int i{0}; i < NumberVertices; i++) {
-        for (int j{i + 1}; j < NumberVertices; j++) {
-            if (adjacent_matrix[i][j] != 0) {
-                edges.push_back({i, j, adjacent_matrix[i][j]});
+    std::vector<int> weight(adjacent_bits.Size());
+    for (int i{0}; i < NumberVertices && i < adjacent_bits.Size(); i++) {
+        // A repeated edge keeps the weight it was inserted with last
+        for (Arc &it : adjacent_list[i]) {
+            weight[it.v] = it.w;
+        }
+
+        const uint64_t *row{adjacent_bits.Row(i)};
+        for (int k{(i + 1) >> 6}; k < (adjacent_bits.Size() + 63) / 64; k++) {
+            uint64_t word{row[k]};
+            if (k == (i + 1) >> 6) {
+                word &= ~uint64_t{0} << ((i + 1) & 63);
+            }
+
+            for (; word != 0; word &= word - 1) {
+                int j{k * 64 + __builtin_ctzll(word)};
+                if (j < NumberVertices && weight[j] != 0) {
+                    edges.push_back({i, j, weight[j]});
+                }
             }
         }
     }
     return edges;
 }
 
-int Graph::Find(std::vector<int> &parent, int vertex) {
-    if (parent[vertex] != vertex) {
-        parent[vertex] = Find(parent, parent[vertex]);
+FilterKruskal::FilterKruskal(int n, int threads)
+    : threads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())), components(n), sets(n), rng(1), edges(nullptr) {}
+
+// Minimum spanning forest in ascending order; reorders the input
+std::vector<Graph::Edge> FilterKruskal::Run(std::vector<Graph::Edge> &input) {
+    edges = &input;
+    if (threads > 1) {
+        scratch.resize(input.size());
     }
-    return parent[vertex];
+    tree.clear();
+    Solve(0, input.size());
+    scratch.clear();
+    scratch.shrink_to_fit();
+    return tree;
 }
 
-void Graph::Union(std::vector<int> &parent, std::vector<int> &rank, int u, int v) {
-    int root_u{Find(parent, u)};
-    int root_v{Find(parent, v)};
-    if (rank[root_u] < rank[root_v]) {
-        parent[root_u] = root_v;
-    } else if (rank[root_u] > rank[root_v]) {
-        parent[root_v] = root_u;
-    } else {
-        parent[root_v] = root_u;
-        rank[root_u]++;
+void FilterKruskal::Solve(size_t lo, size_t hi) {
+    if (lo == hi || components <= 1) {
+        return;
+    }
+    if (hi - lo <= BASE_CASE) {
+        Kruskal(lo, hi);
+        return;
     }
-}
 
-void Graph::KruskalMST() {
-    std::vector<Edge> edges{GetEdges()};
-    std::sort(edges.begin(), edges.end());
+    // Median of a small random sample
+    std::vector<Graph::Edge> sample(63);
+    for (Graph::Edge &e : sample) {
+        e = (*edges)[lo + rng() % (hi - lo)];
+    }
+    std::nth_element(sample.begin(), sample.begin() + sample.size() / 2, sample.end());
+    Graph::Edge pivot{sample[sample.size() / 2]};
 
-    std::vector<int> parent(NumberVertices);
-    std::vector<int> rank(NumberVertices, 0);
+    size_t mid{Split(lo, hi, [&](const Graph::Edge &e) { return !(pivot < e); })};
+    if (mid == hi) {
+        mid = Split(lo, hi, [&](const Graph::Edge &e) { return e < pivot; });
+    }
+    if (mid == lo) {
+        Kruskal(lo, hi);
+        return;
+    }
 
-    for (int i{0}; i < NumberVertices; i++) {
-        parent[i] = i;
+    Solve(lo, mid);
+    if (components <= 1) {
+        return;
+    }
+    size_t end{Split(mid, hi, [&](const Graph::Edge &e) { return sets.Root(e.u) != sets.Root(e.v); })};
+    Solve(mid, end);
+}
+
+void FilterKruskal::Kruskal(size_t lo, size_t hi) {
+    std::sort(edges->begin() + lo, edges->begin() + hi);
+    for (size_t i{lo}; i < hi && components > 1; i++) {
+        const Graph::Edge &edge{(*edges)[i]};
+        if (sets.Union(edge.u, edge.v)) {
+            tree.push_back(edge);
+            components--;
+        }
     }
+}
 
-    std::vector<Edge> mst;
-    for (const Edge &edge : edges) {
-        if (Find(parent, edge.u) != Find(parent, edge.v)) {
-            mst.push_back(edge);
-            Union(parent, rank, edge.u, edge.v);
+// Partition of [lo, hi) with the edges that satisfy keep first. One thread partitions in
+// place. Several threads each count their slice, then copy both kinds through the scratch
+// buffer to their final offsets.
+template <class Keep>
+size_t FilterKruskal::Split(size_t lo, size_t hi, Keep keep) {
+    Graph::Edge *data{edges->data()};
+    int parts{hi - lo < 2 * BASE_CASE ? 1 : threads};
+    if (parts == 1) {
+        return std::partition(data + lo, data + hi, keep) - data;
+    }
+
+    size_t chunk{(hi - lo + parts - 1) / parts};
+    std::vector<size_t> kept(parts + 1, 0);
+
+    ParallelChunks(parts, parts, [&](size_t begin, size_t end) {
+        for (size_t t{begin}; t < end; t++) {
+            size_t count{0};
+            for (size_t i{lo + t * chunk}; i < std::min(hi, lo + (t + 1) * chunk); i++) {
+                count += keep(data[i]);
+            }
+            kept[t + 1] = count;
         }
+    });
+    for (int t{0}; t < parts; t++) {
+        kept[t + 1] += kept[t];
     }
 
+    size_t mid{lo + kept[parts]};
+    ParallelChunks(parts, parts, [&](size_t begin, size_t end) {
+        for (size_t t{begin}; t < end; t++) {
+            size_t first{lo + t * chunk};
+            size_t last{std::min(hi, first + chunk)};
+            size_t yes{lo + kept[t]};
+            size_t no{mid + (first - lo) - kept[t]};
+            for (size_t i{first}; i < last; i++) {
+                if (keep(data[i])) {
+                    scratch[yes++] = data[i];
+                } else {
+                    scratch[no++] = data[i];
+                }
+            }
+        }
+    });
+
+    ParallelChunks(hi - lo, parts, [&](size_t begin, size_t end) {
+        std::copy(scratch.begin() + lo + begin, scratch.begin() + lo + end, data + lo + begin);
+    });
+    return mid;
+}
+
+void Graph::KruskalMST() {
+    std::vector<Edge> edges{GetEdges()};
+    FilterKruskal kruskal(NumberVertices);
+    std::vector<Edge> mst{kruskal.Run(edges)};
+
     std::cout << "Minimum Spanning Tree (Kruskal's Algorithm):" << std::endl;
     for (const Edge &edge : mst) {
         std::cout << edge.u << " - " << edge.v << " : " << edge.weight << std::endl;
@@ -129,23 +388,80 @@ void Graph::KruskalMST() {
 }
 
 void Graph::PrintAdjacentMatrix() {
+    std::vector<int> weight(adjacent_bits.Size());
     for (int i{0}; i < vertices.size(); i++) {
+        for (Arc &it : adjacent_list[i]) {
+            weight[it.v] = it.w;
+        }
+
         for (int j{0}; j < vertices.size(); j++) {
-            if (adjacent_matrix[i][j])
-                std::cout << "(" << i << ", " << j << ", " << adjacent_matrix[i][j] << ")" << std::endl;
+            if (adjacent_bits.Test(i, j) && weight[j])
+                std::cout << "(" << i << ", " << j << ", " << weight[j] << ")" << std::endl;
         }
     }
 }
 
 void Graph::PrintAdjacentList() {
     for (int i{0}; i < vertices.size(); i++) {
-        for (std::vector<int> &it : adjacent_list[i]) {
-            std::cout << "(" << i << ", " << it[0] << ", " << it[1] << ")" << std::endl;
+        for (Arc &it : adjacent_list[i]) {
+            std::cout << "(" << i << ", " << it.v << ", " << it.w << ")" << std::endl;
+        }
+    }
+}
+
+// Same random edges every call: n vertices, weights up to 10^9
+void RandomEdges(std::vector<Graph::Edge> &edges, int n) {
+    std::mt19937 rng(42);
+    for (Graph::Edge &e : edges) {
+        e.u = rng() % n;
+        e.v = rng() % n;
+        e.weight = 1 + rng() % 1000000000;
+    }
+}
+
+// Times the old pipeline (one sequential sort, then Kruskal) against Filter-Kruskal on m
+// random edges over m / 10 vertices, and checks that both pick the same tree
+void Benchmark(size_t m) {
+    int n{static_cast<int>(std::max<size_t>(2, m / 10))};
+    std::vector<Graph::Edge> edges(m);
+
+    RandomEdges(edges, n);
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    std::sort(edges.begin(), edges.end());
+    DisjointSets sets(n);
+    std::vector<Graph::Edge> expected;
+    for (const Graph::Edge &edge : edges) {
+        if (sets.Union(edge.u, edge.v)) {
+            expected.push_back(edge);
+        }
+    }
+    std::chrono::duration<double, std::milli> sortTime{std::chrono::steady_clock::now() - start};
+    std::cout << m << " edges, " << n << " vertices, sort + Kruskal: " << sortTime.count() << " ms" << std::endl;
+
+    int cores{static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+    std::cout << "threads,filter_kruskal_ms,tree_edges,check" << std::endl;
+    for (int threads{1}; threads <= cores; threads = (threads == cores) ? cores + 1 : std::min(threads * 2, cores)) {
+        RandomEdges(edges, n);
+        start = std::chrono::steady_clock::now();
+        FilterKruskal kruskal(n, threads);
+        std::vector<Graph::Edge> tree{kruskal.Run(edges)};
+        std::chrono::duration<double, std::milli> filterTime{std::chrono::steady_clock::now() - start};
+
+        bool same{tree.size() == expected.size()};
+        for (size_t i{0}; same && i < tree.size(); i++) {
+            same = tree[i].u == expected[i].u && tree[i].v == expected[i].v && tree[i].weight == expected[i].weight;
         }
+        std::cout << threads << "," << filterTime.count() << "," << tree.size() << "," << (same ? "ok" : "MISMATCH") << std::endl;
     }
 }
 
-int main(void) {
+// Pass "bench [edges]" to time Filter-Kruskal on a generated graph instead of reading the OJ input
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        Benchmark(argc > 2 ? std::atoll(argv[2]) : 100000000);
+        return 0;
+    }
+
     int u, v, weight;
     int N, M;
 
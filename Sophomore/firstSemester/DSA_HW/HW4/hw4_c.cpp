@@ -1,16 +1,23 @@
 #include <algorithm>
 #include <climits>
+#include <cstdint>
 #include <iostream>
 #include <list>
 #include <vector>
 
 class Graph {
   public:
+    // Weighted edge stored inline in the adjacency list
+    struct Arc {
+        int32_t v;
+        int32_t w;
+    };
+
     Graph();
     void InsertVertex(int v);
     void InsertEdge(int u, int v, int weight = 1);
     bool IsEmpty();
-    std::list<std::vector<int>> Adjacent_List(int u);
+    const std::vector<Arc> &Adjacent_List(int u);
     void PrintAdjacentMatrix();
     void PrintAdjacentList();
     void PrimMST();
@@ -19,8 +26,7 @@ class Graph {
     int NumberVertices;
     int NumberEdges;
     std::list<int> vertices;
-    std::vector<std::vector<int>> adjacent_matrix;
-    std::vector<std::list<std::vector<int>>> adjacent_list;
+    std::vector<std::vector<Arc>> adjacent_list;
 
     struct Edge {
         int u;
@@ -32,6 +38,7 @@ class Graph {
     };
 
     std::vector<Edge> GetEdges();
+    std::vector<int> SortedNeighbours(int i, std::vector<int> &weight);
     int Find(std::vector<int> &parent, int vertex);
     void Union(std::vector<int> &parent, std::vector<int> &rank, int u, int v);
 };
@@ -44,7 +51,7 @@ bool Graph::IsEmpty() {
     return (vertices.size() == 0);
 }
 
-std::list<std::vector<int>> Graph::Adjacent_List(int i) {
+const std::vector<Graph::Arc> &Graph::Adjacent_List(int i) {
     return adjacent_list[i];
 }
 
@@ -56,28 +63,35 @@ void Graph::InsertVertex(int v) {
 }
 
 void Graph::InsertEdge(int u, int v, int weight) {
-    if (adjacent_matrix.size() <= u || adjacent_matrix.size() <= v) {
-        int max_size = std::max(u, v) + 1;
-        adjacent_matrix.resize(max_size, std::vector<int>(max_size, 0));
-    }
-
     if (adjacent_list.size() <= u || adjacent_list.size() <= v) {
         int max_size = std::max(u, v) + 1;
         adjacent_list.resize(max_size);
     }
 
-    adjacent_matrix[u][v] = weight;
-    adjacent_matrix[v][u] = weight;
     adjacent_list[u].push_back({v, weight});
     adjacent_list[v].push_back({u, weight});
 }
 
+// Distinct neighbours of i in increasing order. weight[j] receives the weight the pair
+// (i, j) was inserted with last, which is what the adjacency matrix used to hold.
+std::vector<int> Graph::SortedNeighbours(int i, std::vector<int> &weight) {
+    std::vector<int> neighbours;
+    for (Arc &it : adjacent_list[i]) {
+        weight[it.v] = it.w;
+        neighbours.push_back(it.v);
+    }
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    return neighbours;
+}
+
 std::vector<Graph::Edge> Graph::GetEdges() {
     std::vector<Edge> edges;
-    for (int i{0}; i < NumberVertices; i++) {
-        for (int j{i + 1}; j < NumberVertices; j++) {
-            if (adjacent_matrix[i][j] != 0) {
-                edges.push_back({i, j, adjacent_matrix[i][j]});
+    std::vector<int> weight(adjacent_list.size());
+    for (int i{0}; i < NumberVertices && i < static_cast<int>(adjacent_list.size()); i++) {
+        for (int j : SortedNeighbours(i, weight)) {
+            if (j > i && j < NumberVertices && weight[j] != 0) {
+                edges.push_back({i, j, weight[j]});
             }
         }
     }
@@ -104,9 +118,9 @@ void Graph::PrimMST() {
 
         inMST[u] = true;
 
-        for (std::vector<int> &neighbor : adjacent_list[u]) {
-            int v{neighbor[0]};
-            int weight{neighbor[1]};
+        for (Arc &neighbor : adjacent_list[u]) {
+            int v{neighbor.v};
+            int weight{neighbor.w};
 
             if (!inMST[v] && weight < key[v]) {
                 key[v] = weight;
@@ -122,18 +136,19 @@ void Graph::PrimMST() {
 }
 
 void Graph::PrintAdjacentMatrix() {
+    std::vector<int> weight(adjacent_list.size());
     for (int i{0}; i < vertices.size(); i++) {
-        for (int j{0}; j < vertices.size(); j++) {
-            if (adjacent_matrix[i][j])
-                std::cout << "(" << i << ", " << j << ", " << adjacent_matrix[i][j] << ")" << std::endl;
+        for (int j : SortedNeighbours(i, weight)) {
+            if (j < vertices.size() && weight[j])
+                std::cout << "(" << i << ", " << j << ", " << weight[j] << ")" << std::endl;
         }
     }
 }
 
 void Graph::PrintAdjacentList() {
     for (int i{0}; i < vertices.size(); i++) {
-        for (std::vector<int> &it : adjacent_list[i]) {
-            std::cout << "(" << i << ", " << it[0] << ", " << it[1] << ")" << std::endl;
+        for (Arc &it : adjacent_list[i]) {
+            std::cout << "(" << i << ", " << it.v << ", " << it.w << ")" << std::endl;
         }
     }
 }
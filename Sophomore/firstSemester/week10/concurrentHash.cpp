@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define MAX_THREADS 128
+
+// Every thread that touches a ConcurrentHash owns one slot, released when the thread exits
+class ThreadSlot {
+  public:
+    ThreadSlot() : id(-1) {
+        for (int j{0}; j < MAX_THREADS; j++) {
+            bool expected{false};
+            if (used[j].compare_exchange_strong(expected, true)) {
+                id = j;
+                return;
+            }
+        }
+        std::cerr << "Too many threads for the epoch manager" << std::endl;
+        std::abort();
+    }
+
+    ~ThreadSlot() {
+        used[id].store(false);
+    }
+
+    static int get() {
+        thread_local ThreadSlot slot;
+        return slot.id;
+    }
+
+  private:
+    int id;
+    static std::atomic<bool> used[MAX_THREADS];
+};
+
+std::atomic<bool> ThreadSlot::used[MAX_THREADS]{};
+
+// Epoch based reclamation: readers publish the global epoch while they traverse,
+// writers retire unlinked nodes and free them once no reader can still hold them
+class EpochManager {
+  public:
+    EpochManager() : globalEpoch(1) {
+        for (int j{0}; j < MAX_THREADS; j++) {
+            local[j].epoch.store(0);
+        }
+    }
+
+    ~EpochManager() {
+        for (const Retired &r : retired) {
+            r.deleter(r.ptr);
+        }
+    }
+
+    void enter() {
+        local[ThreadSlot::get()].epoch.store(globalEpoch.load());
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    void exit() {
+        local[ThreadSlot::get()].epoch.store(0, std::memory_order_release);
+    }
+
+    void retire(void *ptr, void (*deleter)(void *)) {
+        std::lock_guard<std::mutex> lock(retireMutex);
+        retired.push_back({ptr, deleter, globalEpoch.load()});
+        if (retired.size() >= 256) {
+            reclaim();
+        }
+    }
+
+  private:
+    struct Retired {
+        void *ptr;
+        void (*deleter)(void *);
+        uint64_t epoch;
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch;
+    };
+
+    std::atomic<uint64_t> globalEpoch;
+    Slot local[MAX_THREADS];
+    std::mutex retireMutex;
+    std::vector<Retired> retired;
+
+    void reclaim() {
+        globalEpoch.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        uint64_t oldest{UINT64_MAX};
+        for (int j{0}; j < MAX_THREADS; j++) {
+            uint64_t e{local[j].epoch.load()};
+            if (e != 0) {
+                oldest = std::min(oldest, e);
+            }
+        }
+
+        std::vector<Retired> keep;
+        for (const Retired &r : retired) {
+            if (r.epoch < oldest) {
+                r.deleter(r.ptr);
+            } else {
+                keep.push_back(r);
+            }
+        }
+        retired.swap(keep);
+    }
+};
+
+// Thread-safe variant of Hash: writers lock one stripe of buckets, readers never lock
+template <class T1, class T2>
+class ConcurrentHash {
+  public:
+    struct Pair {
+        T1 key;
+        T2 value;
+
+        Pair() {}
+
+        Pair(T1 k, const T2 &v) : key(k), value(v) {}
+    };
+
+    ConcurrentHash(unsigned int buckets = 1024) : size(1), locks(SHARDS) {
+        while (size < buckets) {
+            size <<= 1;
+        }
+
+        table = new std::atomic<Entry *>[size];
+        for (unsigned int j{0}; j < size; j++) {
+            table[j].store(nullptr);
+        }
+    }
+
+    ~ConcurrentHash() {
+        for (unsigned int j{0}; j < size; j++) {
+            Entry *e{table[j].load()};
+            while (e != nullptr) {
+                Entry *next{e->next.load()};
+                delete e;
+                e = next;
+            }
+        }
+        delete[] table;
+    }
+
+    // Insert or overwrite, returns false when the key was already present
+    bool insert(T1 key, const T2 &value) {
+        unsigned int hash{HashFunction(key)};
+        std::lock_guard<std::mutex> lock(locks[hash & (SHARDS - 1)].m);
+
+        std::atomic<Entry *> *link{&table[hash]};
+        for (Entry *e{link->load()}; e != nullptr; link = &e->next, e = link->load()) {
+            if (e->pair.key == key) {
+                Entry *replacement{new Entry(key, value)};
+                replacement->next.store(e->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                link->store(replacement, std::memory_order_release);
+                epoch.retire(e, deleteEntry);
+                return false;
+            }
+        }
+
+        Entry *node{new Entry(key, value)};
+        node->next.store(table[hash].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        table[hash].store(node, std::memory_order_release);
+        return true;
+    }
+
+    bool search(T1 key, T2 &value) {
+        unsigned int hash{HashFunction(key)};
+        epoch.enter();
+
+        for (Entry *e{table[hash].load(std::memory_order_acquire)}; e != nullptr; e = e->next.load(std::memory_order_acquire)) {
+            if (e->pair.key == key) {
+                value = e->pair.value;
+                epoch.exit();
+                return true;
+            }
+        }
+
+        epoch.exit();
+        return false;
+    }
+
+    bool erase(T1 key) {
+        unsigned int hash{HashFunction(key)};
+        std::lock_guard<std::mutex> lock(locks[hash & (SHARDS - 1)].m);
+
+        std::atomic<Entry *> *link{&table[hash]};
+        for (Entry *e{link->load()}; e != nullptr; link = &e->next, e = link->load()) {
+            if (e->pair.key == key) {
+                link->store(e->next.load(std::memory_order_relaxed), std::memory_order_release);
+                epoch.retire(e, deleteEntry);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Returns the cached value, computing and inserting it under the stripe lock if missing
+    T2 computeIfAbsent(T1 key, std::function<T2(const T1 &)> compute) {
+        T2 value;
+        if (search(key, value)) {
+            return value;
+        }
+
+        unsigned int hash{HashFunction(key)};
+        std::lock_guard<std::mutex> lock(locks[hash & (SHARDS - 1)].m);
+
+        for (Entry *e{table[hash].load()}; e != nullptr; e = e->next.load()) {
+            if (e->pair.key == key) {
+                return e->pair.value;
+            }
+        }
+
+        Entry *node{new Entry(key, compute(key))};
+        node->next.store(table[hash].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        table[hash].store(node, std::memory_order_release);
+        return node->pair.value;
+    }
+
+  private:
+    static constexpr unsigned int SHARDS{64};
+
+    struct Entry {
+        Pair pair;
+        std::atomic<Entry *> next;
+
+        Entry(T1 k, const T2 &v) : pair(k, v), next(nullptr) {}
+    };
+
+    struct alignas(64) Stripe {
+        std::mutex m;
+    };
+
+    unsigned int size;
+    std::atomic<Entry *> *table;
+    std::vector<Stripe> locks;
+    EpochManager epoch;
+
+    static void deleteEntry(void *p) {
+        delete static_cast<Entry *>(p);
+    }
+
+    unsigned int HashFunction(T1 key) {
+        uint64_t hash{std::hash<T1>{}(key)};
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return static_cast<unsigned int>(hash) & (size - 1);
+    }
+};
+
+// Mixed workload: 80% search, 10% insert, 5% erase, 5% computeIfAbsent
+double benchmark(ConcurrentHash<int, std::string> &hash, int threads, int opsPerThread, int keyRange) {
+    std::vector<std::thread> workers;
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+
+    for (int t{0}; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng(t + 1);
+            std::string value;
+            ready++;
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+
+            for (int j{0}; j < opsPerThread; j++) {
+                int key{static_cast<int>(rng() % keyRange)};
+                int op{static_cast<int>(rng() % 100)};
+                if (op < 80) {
+                    hash.search(key, value);
+                } else if (op < 90) {
+                    hash.insert(key, std::to_string(key));
+                } else if (op < 95) {
+                    hash.erase(key);
+                } else {
+                    hash.computeIfAbsent(key, [](const int &k) { return std::to_string(k); });
+                }
+            }
+        });
+    }
+
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    go.store(true);
+    for (std::thread &w : workers) {
+        w.join();
+    }
+    std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+    return threads * static_cast<double>(opsPerThread) / elapsed.count();
+}
+
+int main(void) {
+    ConcurrentHash<int, std::string> hash;
+
+    for (int j{1000}; j < 1024; j++) {
+        hash.insert(j, std::to_string(j));
+    }
+
+    std::string value;
+    for (int j{1000}; j < 1030; j++) {
+        if (hash.search(j, value)) {
+            std::cout << value << std::endl;
+        } else {
+            std::cout << "miss" << std::endl;
+        }
+    }
+
+    const int keyRange{1 << 16};
+    ConcurrentHash<int, std::string> shared(keyRange);
+    for (int j{0}; j < keyRange; j += 2) {
+        shared.insert(j, std::to_string(j));
+    }
+
+    int cores{static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+    std::cout << "threads,ops_per_sec" << std::endl;
+    for (int threads{1}; threads <= cores; threads = (threads == cores) ? cores + 1 : std::min(threads * 2, cores)) {
+        double rate{benchmark(shared, threads, 1000000, keyRange)};
+        std::cout << threads << "," << static_cast<long long>(rate) << std::endl;
+    }
+}
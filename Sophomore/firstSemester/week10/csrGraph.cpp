@@ -0,0 +1,767 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+template <class T>
+class Node {
+  public:
+    Node() : data(std::make_unique<T>()) {}
+
+    Node(T d) : data(std::make_unique<T>(d)) {}
+
+    Node &operator=(T d) {
+        *data = d;
+        return *this;
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, const Node &n) {
+        out << *(n.data);
+        return out;
+    }
+
+    void setData(T d) {
+        *data = d;
+    }
+
+    T &getData() const {
+        return *data;
+    }
+
+  private:
+    std::unique_ptr<T> data;
+};
+
+template <class T>
+class ListNode : public Node<T> {
+  public:
+    ListNode() : Node<T>(), prev(nullptr), next(nullptr) {}
+
+    ListNode(T d) : Node<T>(d), prev(nullptr), next(nullptr) {}
+
+    ListNode(std::shared_ptr<ListNode<T>> p, std::shared_ptr<ListNode<T>> n)
+        : Node<T>(), prev(p), next(n) {}
+
+    ListNode(T d, std::shared_ptr<ListNode<T>> p, std::shared_ptr<ListNode<T>> n)
+        : Node<T>(d), prev(p), next(n) {}
+
+    std::shared_ptr<ListNode<T>> getNext() const {
+        return next;
+    }
+
+    std::shared_ptr<ListNode<T>> getPrev() const {
+        return prev;
+    }
+
+    void setNext(std::shared_ptr<ListNode<T>> n) {
+        next = n;
+    }
+
+    void setPrev(std::shared_ptr<ListNode<T>> p) {
+        prev = p;
+    }
+
+  private:
+    std::shared_ptr<ListNode<T>> prev;
+    std::shared_ptr<ListNode<T>> next;
+};
+
+template <class T>
+class LinkList {
+  public:
+    LinkList() : head(nullptr), tail(nullptr) {}
+
+    void addFromHead(T d) {
+        std::shared_ptr<ListNode<T>> node{std::make_shared<ListNode<T>>(d)};
+        if (head != nullptr) {
+            head->setPrev(node);
+        }
+
+        node->setNext(head);
+        head = node;
+        if (tail == nullptr) {
+            tail = head;
+        }
+    }
+
+    void addFromTail(T d) {
+        std::shared_ptr<ListNode<T>> node{std::make_shared<ListNode<T>>(d)};
+        if (tail != nullptr) {
+            tail->setNext(node);
+        }
+
+        node->setPrev(tail);
+        tail = node;
+        if (head == nullptr) {
+            head = tail;
+        }
+    }
+
+    void addAfter(std::shared_ptr<ListNode<T>> node, T d) {
+        if (!exist(node)) {
+            return;
+        }
+
+        std::shared_ptr<ListNode<T>> newNode{std::make_shared<ListNode<T>>(d)};
+        if (node->getNext() != nullptr)
+            node->getNext()->setPrev(newNode);
+
+        newNode->setNext(node->getNext());
+        node->setNext(newNode);
+        newNode->setPrev(node);
+
+        if (newNode->getNext() == nullptr)
+            tail = newNode;
+    }
+
+    std::shared_ptr<ListNode<T>> removeFromHead() {
+        std::shared_ptr<ListNode<T>> node{head};
+        if (head != nullptr) {
+            head = head->getNext();
+            if (head != nullptr)
+                head->setPrev(nullptr);
+            else
+                tail = nullptr;
+            node->setNext(nullptr);
+        }
+        return node;
+    }
+
+    std::shared_ptr<ListNode<T>> removeFromTail() {
+        std::shared_ptr<ListNode<T>> node{tail};
+        if (tail != nullptr) {
+            tail = tail->getPrev();
+
+            if (tail != nullptr)
+                tail->setNext(nullptr);
+            else
+                head = nullptr;
+            node->setPrev(nullptr);
+        }
+        return node;
+    }
+
+    std::shared_ptr<ListNode<T>> remove(std::shared_ptr<ListNode<T>> node) {
+        if (!exist(node)) {
+            return nullptr;
+        }
+
+        if (node == head) {
+            return removeFromHead();
+        } else if (node == tail) {
+            return removeFromTail();
+        } else {
+            node->getPrev()->setNext(node->getNext());
+            node->getNext()->setPrev(node->getPrev());
+            node->setPrev(nullptr);
+            node->setNext(nullptr);
+            return node;
+        }
+    }
+
+    bool exist(std::shared_ptr<ListNode<T>> node) {
+        for (std::shared_ptr<ListNode<T>> j{head}; j != nullptr; j = j->getNext()) {
+            if (j == node) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::shared_ptr<ListNode<T>> exist(T d) {
+        for (std::shared_ptr<ListNode<T>> j{head}; j != nullptr; j = j->getNext()) {
+            if (j->getData() == d) {
+                return j;
+            }
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<const ListNode<T>> &operator[](int n) {
+        std::shared_ptr<ListNode<T>> j{head};
+        for (int i{0}; i < n; i++) {
+            if (j == nullptr) {
+                throw std::out_of_range("Index out of range");
+            }
+            j = j->getNext();
+        }
+        return j;
+    }
+
+    void print() const {
+        std::shared_ptr<ListNode<T>> j{head};
+        while (j != nullptr) {
+            std::cout << *j << " ";
+            j = j->getNext();
+        }
+        std::cout << std::endl;
+    }
+
+    std::shared_ptr<ListNode<T>> head;
+    std::shared_ptr<ListNode<T>> tail;
+};
+
+template <class V, class E>
+class WeightedGraphEdge;
+
+template <class V, class E>
+class WeightedGraphVertex : public Node<V> {
+  public:
+    WeightedGraphVertex() : Node<V>(), list(std::make_shared<LinkList<WeightedGraphEdge<V, E> *>>()) {}
+
+    WeightedGraphVertex(V d) : Node<V>(d), list(std::make_shared<LinkList<WeightedGraphEdge<V, E> *>>()) {}
+
+    void addEdge(std::shared_ptr<WeightedGraphEdge<V, E>> edge) {
+        list->addFromTail(edge.get());
+    }
+
+    std::shared_ptr<ListNode<WeightedGraphEdge<V, E> *>> operator[](int n) {
+        std::shared_ptr<ListNode<WeightedGraphEdge<V, E> *>> cur{list->head};
+
+        for (int i{0}; cur != nullptr; i++) {
+            if (i == n) {
+                return cur;
+            }
+
+            cur = cur->getNext();
+        }
+
+        return nullptr;
+    }
+
+  private:
+    std::shared_ptr<LinkList<WeightedGraphEdge<V, E> *>> list;
+};
+
+template <class V, class E>
+class WeightedGraphEdge : public Node<E> {
+  public:
+    WeightedGraphEdge() : Node<E>(), end{nullptr, nullptr} {}
+
+    WeightedGraphEdge(E d) : Node<E>(d), end{nullptr, nullptr} {}
+
+    WeightedGraphEdge(E d, std::shared_ptr<WeightedGraphVertex<V, E>> v1, std::shared_ptr<WeightedGraphVertex<V, E>> v2)
+        : Node<E>(d), end{v1, v2} {}
+
+    std::shared_ptr<WeightedGraphVertex<V, E>> getAnotherEnd(std::shared_ptr<WeightedGraphVertex<V, E>> v) {
+        return (v != end[0]) ? end[0] : end[1];
+    }
+
+    std::shared_ptr<WeightedGraphVertex<V, E>> getEnd(int i) const {
+        return end[i];
+    }
+
+  private:
+    std::shared_ptr<WeightedGraphVertex<V, E>> end[2];
+};
+
+template <class V, class E>
+class WeightedGraph {
+  public:
+    WeightedGraph() : vertexCount(0), edgeCount(0), vertex(std::make_shared<LinkList<std::shared_ptr<WeightedGraphVertex<V, E>>>>()),
+                      edge(std::make_shared<LinkList<std::shared_ptr<WeightedGraphEdge<V, E>>>>()) {}
+
+    std::shared_ptr<WeightedGraphVertex<V, E>> operator[](int n) {
+        std::shared_ptr<ListNode<std::shared_ptr<WeightedGraphVertex<V, E>>>> cur = vertex->head;
+
+        int i{0};
+        while (cur != nullptr) {
+            if (i == n) {
+                return cur->getData();
+            }
+
+            cur = cur->getNext();
+            i++;
+        }
+        return nullptr;
+    }
+
+    void addLink(std::shared_ptr<WeightedGraphVertex<V, E>> v1, std::shared_ptr<WeightedGraphVertex<V, E>> v2, E w) {
+        std::shared_ptr<WeightedGraphEdge<V, E>> edge{std::make_shared<WeightedGraphEdge<V, E>>(w, v1, v2)};
+
+        v1->addEdge(edge);
+        if (v1 != v2) {
+            v2->addEdge(edge);
+        }
+
+        this->edge->addFromTail(edge);
+    }
+
+    std::shared_ptr<WeightedGraphVertex<V, E>> addVertex(V d) {
+        std::shared_ptr<WeightedGraphVertex<V, E>> v{std::make_shared<WeightedGraphVertex<V, E>>(d)};
+
+        vertex->addFromTail(v);
+        vertexCount++;
+
+        return v;
+    }
+
+    void adjList() {
+        std::shared_ptr<ListNode<std::shared_ptr<WeightedGraphVertex<V, E>>>> cur{vertex->head};
+        while (cur != nullptr) {
+            std::shared_ptr<WeightedGraphVertex<V, E>> temp{cur->getData()};
+            std::cout << *temp << ": ";
+            std::shared_ptr<ListNode<WeightedGraphEdge<V, E> *>> e = (*temp)[0];
+
+            while (e != nullptr) {
+                std::cout << *e->getData()->getAnotherEnd(temp) << "(" << e->getData()->getData() << ") ";
+                e = e->getNext();
+            }
+
+            std::cout << std::endl;
+            cur = cur->getNext();
+        }
+    }
+
+    template <class F>
+    void forEachVertex(F f) const {
+        for (std::shared_ptr<ListNode<std::shared_ptr<WeightedGraphVertex<V, E>>>> cur{vertex->head}; cur != nullptr; cur = cur->getNext()) {
+            f(cur->getData());
+        }
+    }
+
+    template <class F>
+    void forEachEdge(F f) const {
+        for (std::shared_ptr<ListNode<std::shared_ptr<WeightedGraphEdge<V, E>>>> cur{edge->head}; cur != nullptr; cur = cur->getNext()) {
+            f(cur->getData());
+        }
+    }
+
+  private:
+    int vertexCount;
+    int edgeCount;
+    std::shared_ptr<LinkList<std::shared_ptr<WeightedGraphVertex<V, E>>>> vertex;
+    std::shared_ptr<LinkList<std::shared_ptr<WeightedGraphEdge<V, E>>>> edge;
+};
+
+// Immutable compressed sparse row graph: the arcs leaving u are
+// target[offset[u]] .. target[offset[u + 1] - 1] with matching weight[] entries.
+// Undirected edges are stored once in each direction; vertex ids are dense 32-bit.
+template <class E>
+class CSRGraph {
+  public:
+    struct Edge {
+        uint32_t u;
+        uint32_t v;
+        E w;
+    };
+
+    static constexpr uint32_t NONE{UINT32_MAX};
+
+    CSRGraph(uint32_t n, const std::vector<Edge> &edges, bool undirected = true) : edges(edges.size()), offset(n + 1, 0) {
+        for (const Edge &e : edges) {
+            offset[e.u + 1]++;
+            if (undirected && e.u != e.v) {
+                offset[e.v + 1]++;
+            }
+        }
+        for (uint32_t u{0}; u < n; u++) {
+            offset[u + 1] += offset[u];
+        }
+
+        target.resize(offset[n]);
+        weight.resize(offset[n]);
+        std::vector<uint32_t> cursor(offset.begin(), offset.end() - 1);
+        for (const Edge &e : edges) {
+            target[cursor[e.u]] = e.v;
+            weight[cursor[e.u]++] = e.w;
+            if (undirected && e.u != e.v) {
+                target[cursor[e.v]] = e.u;
+                weight[cursor[e.v]++] = e.w;
+            }
+        }
+    }
+
+    // Numbers the vertices of g in list order; labels[id] gives back the vertex data
+    template <class V>
+    static CSRGraph fromWeightedGraph(const WeightedGraph<V, E> &g, std::vector<V> &labels) {
+        std::unordered_map<WeightedGraphVertex<V, E> *, uint32_t> id;
+        labels.clear();
+        g.forEachVertex([&](const std::shared_ptr<WeightedGraphVertex<V, E>> &v) {
+            id[v.get()] = static_cast<uint32_t>(labels.size());
+            labels.push_back(v->getData());
+        });
+
+        std::vector<Edge> list;
+        g.forEachEdge([&](const std::shared_ptr<WeightedGraphEdge<V, E>> &e) {
+            list.push_back({id[e->getEnd(0).get()], id[e->getEnd(1).get()], e->getData()});
+        });
+
+        return CSRGraph(static_cast<uint32_t>(labels.size()), list);
+    }
+
+    uint32_t vertexCount() const {
+        return static_cast<uint32_t>(offset.size() - 1);
+    }
+
+    uint64_t edgeCount() const {
+        return edges;
+    }
+
+    uint32_t degree(uint32_t u) const {
+        return offset[u + 1] - offset[u];
+    }
+
+    uint32_t begin(uint32_t u) const {
+        return offset[u];
+    }
+
+    uint32_t end(uint32_t u) const {
+        return offset[u + 1];
+    }
+
+    uint32_t neighbor(uint32_t arc) const {
+        return target[arc];
+    }
+
+    E cost(uint32_t arc) const {
+        return weight[arc];
+    }
+
+    // Returns the visiting order; level[v] is the hop distance or NONE when unreachable
+    std::vector<uint32_t> BFS(uint32_t source, std::vector<uint32_t> &level, std::vector<uint32_t> &parent) const {
+        std::vector<uint32_t> order;
+        order.reserve(vertexCount());
+        level.assign(vertexCount(), NONE);
+        parent.assign(vertexCount(), NONE);
+
+        level[source] = 0;
+        order.push_back(source);
+        for (size_t head{0}; head < order.size(); head++) {
+            uint32_t u{order[head]};
+            for (uint32_t a{offset[u]}; a < offset[u + 1]; a++) {
+                uint32_t v{target[a]};
+                if (level[v] == NONE) {
+                    level[v] = level[u] + 1;
+                    parent[v] = u;
+                    order.push_back(v);
+                }
+            }
+        }
+        return order;
+    }
+
+    // Iterative preorder DFS; each stack frame remembers the next arc to try
+    std::vector<uint32_t> DFS(uint32_t source) const {
+        std::vector<uint32_t> order;
+        std::vector<bool> visited(vertexCount(), false);
+        std::vector<std::pair<uint32_t, uint32_t>> stack;
+        stack.reserve(64);
+
+        visited[source] = true;
+        order.push_back(source);
+        stack.push_back({source, offset[source]});
+        while (!stack.empty()) {
+            std::pair<uint32_t, uint32_t> &frame{stack.back()};
+            if (frame.second == offset[frame.first + 1]) {
+                stack.pop_back();
+                continue;
+            }
+
+            uint32_t v{target[frame.second++]};
+            if (!visited[v]) {
+                visited[v] = true;
+                order.push_back(v);
+                stack.push_back({v, offset[v]});
+            }
+        }
+        return order;
+    }
+
+    // dist[v] is numeric_limits<E>::max() when v cannot be reached
+    void Dijkstra(uint32_t source, std::vector<E> &dist, std::vector<uint32_t> &parent) const {
+        dist.assign(vertexCount(), std::numeric_limits<E>::max());
+        parent.assign(vertexCount(), NONE);
+
+        std::priority_queue<std::pair<E, uint32_t>, std::vector<std::pair<E, uint32_t>>, std::greater<std::pair<E, uint32_t>>> pq;
+        dist[source] = 0;
+        pq.push({0, source});
+        while (!pq.empty()) {
+            std::pair<E, uint32_t> top{pq.top()};
+            pq.pop();
+            uint32_t u{top.second};
+            if (top.first != dist[u]) {
+                continue;
+            }
+
+            for (uint32_t a{offset[u]}; a < offset[u + 1]; a++) {
+                uint32_t v{target[a]};
+                if (dist[u] + weight[a] < dist[v]) {
+                    dist[v] = dist[u] + weight[a];
+                    parent[v] = u;
+                    pq.push({dist[v], v});
+                }
+            }
+        }
+    }
+
+    // Prim from every unvisited vertex, so a disconnected graph yields a spanning forest
+    std::vector<Edge> MST() const {
+        std::vector<Edge> tree;
+        std::vector<bool> visited(vertexCount(), false);
+        std::priority_queue<std::pair<E, std::pair<uint32_t, uint32_t>>, std::vector<std::pair<E, std::pair<uint32_t, uint32_t>>>,
+                            std::greater<std::pair<E, std::pair<uint32_t, uint32_t>>>>
+            pq;
+
+        for (uint32_t start{0}; start < vertexCount(); start++) {
+            if (visited[start]) {
+                continue;
+            }
+
+            visited[start] = true;
+            for (uint32_t a{offset[start]}; a < offset[start + 1]; a++) {
+                pq.push({weight[a], {start, a}});
+            }
+
+            while (!pq.empty()) {
+                std::pair<E, std::pair<uint32_t, uint32_t>> top{pq.top()};
+                pq.pop();
+                uint32_t v{target[top.second.second]};
+                if (visited[v]) {
+                    continue;
+                }
+
+                visited[v] = true;
+                tree.push_back({top.second.first, v, top.first});
+                for (uint32_t a{offset[v]}; a < offset[v + 1]; a++) {
+                    if (!visited[target[a]]) {
+                        pq.push({weight[a], {v, a}});
+                    }
+                }
+            }
+        }
+        return tree;
+    }
+
+  private:
+    uint64_t edges;
+    std::vector<uint32_t> offset;
+    std::vector<uint32_t> target;
+    std::vector<E> weight;
+};
+
+// n vertices, m edges with uniformly random endpoints
+std::vector<CSRGraph<int>::Edge> randomGraph(uint32_t n, uint64_t m, std::mt19937 &rng) {
+    std::vector<CSRGraph<int>::Edge> edges;
+    edges.reserve(m);
+    for (uint64_t j{0}; j < m; j++) {
+        edges.push_back({static_cast<uint32_t>(rng() % n), static_cast<uint32_t>(rng() % n), static_cast<int>(rng() % 100) + 1});
+    }
+    return edges;
+}
+
+// Preferential attachment: each new vertex links to k endpoints of earlier edges
+std::vector<CSRGraph<int>::Edge> powerLawGraph(uint32_t n, uint32_t k, std::mt19937 &rng) {
+    std::vector<CSRGraph<int>::Edge> edges;
+    std::vector<uint32_t> endpoints;
+    edges.reserve(static_cast<size_t>(n) * k);
+    endpoints.reserve(static_cast<size_t>(n) * k * 2);
+
+    for (uint32_t v{1}; v < n; v++) {
+        for (uint32_t j{0}; j < k; j++) {
+            uint32_t u{endpoints.empty() ? 0 : endpoints[rng() % endpoints.size()]};
+            edges.push_back({v, u, static_cast<int>(rng() % 100) + 1});
+            endpoints.push_back(u);
+            endpoints.push_back(v);
+        }
+    }
+    return edges;
+}
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void benchmark(const std::string &name, uint32_t n, const std::vector<CSRGraph<int>::Edge> &edges) {
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    CSRGraph<int> g(n, edges);
+    double build{elapsedSince(start)};
+
+    std::vector<uint32_t> level;
+    std::vector<uint32_t> parent;
+    start = std::chrono::steady_clock::now();
+    size_t reached{g.BFS(0, level, parent).size()};
+    double bfs{elapsedSince(start)};
+
+    start = std::chrono::steady_clock::now();
+    size_t dfsReached{g.DFS(0).size()};
+    double dfs{elapsedSince(start)};
+
+    std::vector<int> dist;
+    start = std::chrono::steady_clock::now();
+    g.Dijkstra(0, dist, parent);
+    double dijkstra{elapsedSince(start)};
+
+    start = std::chrono::steady_clock::now();
+    std::vector<CSRGraph<int>::Edge> tree{g.MST()};
+    double mst{elapsedSince(start)};
+
+    long long total{0};
+    for (const CSRGraph<int>::Edge &e : tree) {
+        total += e.w;
+    }
+
+    std::cout << name << ": " << g.vertexCount() << " vertices, " << g.edgeCount() << " edges" << std::endl;
+    std::cout << "  build " << build << " ms, BFS " << bfs << " ms (" << reached << " reached), DFS " << dfs << " ms (" << dfsReached
+              << " reached), Dijkstra " << dijkstra << " ms, MST " << mst << " ms (" << tree.size() << " edges, weight " << total << ")" << std::endl;
+}
+
+// Edge file written by week10/graphIO.cpp: a 48-byte header, then packed (u, v, w) triples
+struct EdgeFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t vertexCount;
+    uint64_t edgeCount;
+    uint64_t edgeOffset;
+    uint64_t fileSize;
+};
+
+struct FileEdge {
+    uint32_t u;
+    uint32_t v;
+    int32_t w;
+};
+
+// The edge count is checked against the file length before anything is allocated for it
+bool readEdgeFile(const std::string &path, uint32_t &n, std::vector<FileEdge> &edges) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    std::streamoff length{in.tellg()};
+    EdgeFileHeader header;
+    if (length < static_cast<std::streamoff>(sizeof(header)) || !in.seekg(0) || !in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "NDHUEDG1", 8) != 0 || header.version != 1 || header.vertexCount == 0 || header.vertexCount > INT32_MAX ||
+        header.edgeOffset < sizeof(header) || header.edgeOffset > static_cast<uint64_t>(length) ||
+        header.edgeCount > (static_cast<uint64_t>(length) - header.edgeOffset) / sizeof(FileEdge)) {
+        return false;
+    }
+
+    n = static_cast<uint32_t>(header.vertexCount);
+    edges.resize(header.edgeCount);
+    in.seekg(header.edgeOffset);
+    if (!in.read(reinterpret_cast<char *>(edges.data()), edges.size() * sizeof(FileEdge))) {
+        return false;
+    }
+    for (const FileEdge &e : edges) {
+        if (e.u >= n || e.v >= n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// "run <edges file> <bfs|dfs|dijkstra|mst>": times one algorithm from vertex 0 and prints
+// algorithm,ms,checksum for week10/graphBenchmark.cpp. MST() spans every component, but the
+// mst checksum only counts the tree of vertex 0, like the Prim runs of the other programs.
+int runFile(const std::string &path, const std::string &algorithm) {
+    uint32_t n;
+    std::vector<FileEdge> file;
+    if (!readEdgeFile(path, n, file)) {
+        std::cerr << "Could not read " << path << std::endl;
+        return 1;
+    }
+
+    std::vector<CSRGraph<int>::Edge> edges(file.size());
+    for (size_t j{0}; j < file.size(); j++) {
+        edges[j] = {file[j].u, file[j].v, file[j].w};
+    }
+    file = std::vector<FileEdge>();
+    CSRGraph<int> g(n, edges);
+    edges = std::vector<CSRGraph<int>::Edge>();
+
+    std::vector<uint32_t> level;
+    std::vector<uint32_t> parent;
+    std::vector<int> dist;
+    std::vector<uint32_t> component;
+    if (algorithm == "mst") {
+        g.BFS(0, component, parent);
+    }
+
+    long long checksum{0};
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    if (algorithm == "bfs") {
+        checksum = g.BFS(0, level, parent).size();
+    } else if (algorithm == "dfs") {
+        checksum = g.DFS(0).size();
+    } else if (algorithm == "dijkstra") {
+        g.Dijkstra(0, dist, parent);
+        for (int d : dist) {
+            checksum += d == std::numeric_limits<int>::max() ? 0 : d;
+        }
+    } else if (algorithm == "mst") {
+        for (const CSRGraph<int>::Edge &e : g.MST()) {
+            checksum += component[e.u] == CSRGraph<int>::NONE ? 0 : e.w;
+        }
+    } else {
+        std::cerr << "Unknown algorithm " << algorithm << std::endl;
+        return 2;
+    }
+    double elapsed{elapsedSince(start)};
+
+    std::cout << algorithm << "," << elapsed << "," << checksum << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 3 && std::string(argv[1]) == "run") {
+        return runFile(argv[2], argv[3]);
+    }
+
+    std::shared_ptr<WeightedGraph<char, int>> g{std::make_shared<WeightedGraph<char, int>>()};
+    for (int j{0}; j < 6; j++) {
+        g->addVertex(j + 'a');
+    }
+
+    int links[][3]{{0, 1, 2}, {0, 2, 3}, {1, 3, 5}, {2, 3, 1}, {2, 4, 6}, {3, 5, 4}};
+    for (int j{0}; j < 6; j++) {
+        g->addLink((*g)[links[j][0]], (*g)[links[j][1]], links[j][2]);
+    }
+    g->adjList();
+
+    std::vector<char> labels;
+    CSRGraph<int> csr{CSRGraph<int>::fromWeightedGraph(*g, labels)};
+
+    std::vector<uint32_t> level;
+    std::vector<uint32_t> parent;
+    std::cout << "BFS: ";
+    for (uint32_t v : csr.BFS(0, level, parent)) {
+        std::cout << labels[v] << " ";
+    }
+    std::cout << std::endl
+              << "DFS: ";
+    for (uint32_t v : csr.DFS(0)) {
+        std::cout << labels[v] << " ";
+    }
+    std::cout << std::endl;
+
+    std::vector<int> dist;
+    csr.Dijkstra(0, dist, parent);
+    std::cout << "Dijkstra from " << labels[0] << ": ";
+    for (uint32_t v{0}; v < csr.vertexCount(); v++) {
+        std::cout << labels[v] << "=" << dist[v] << " ";
+    }
+    std::cout << std::endl
+              << "MST: ";
+    for (const CSRGraph<int>::Edge &e : csr.MST()) {
+        std::cout << labels[e.u] << "-" << labels[e.v] << "(" << e.w << ") ";
+    }
+    std::cout << std::endl
+              << std::endl;
+
+    uint32_t n{argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 1000000};
+    std::mt19937 rng(12345);
+    benchmark("Random", n, randomGraph(n, static_cast<uint64_t>(n) * 4, rng));
+    benchmark("Power-law", n, powerLawGraph(n, 4, rng));
+}
@@ -0,0 +1,393 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Benchmark suite for the graph programs in this tree. It generates reproducible synthetic
+// graphs, runs every implementation on them as a child process (so each run gets its own
+// peak memory figure from wait4) and prints one CSV row per run.
+//
+// Programs with a "run <edges file> <algorithm>" mode (csrGraph, DFS_BFS, forest,
+// minimumSpanningTree, shortestPathTree, and hw4_d for delta-stepping) read the binary
+// edge format of graphIO.cpp and report their own algorithm time. The DSA_HW/HW4 programs
+// otherwise read their OJ text layout on stdin and are timed as a whole.
+//
+// Checksums agree between implementations of the same algorithm: bfs and dfs count the
+// vertices reached from 0, dijkstra and delta-stepping sum the finite distances from 0, and
+// every mst sums the weight of the tree spanning vertex 0's component.
+//
+// Build the programs into one directory, e.g.
+//   g++ -std=c++20 -O2 -pthread -o bin/csrGraph week10/csrGraph.cpp
+// for csrGraph, DFS_BFS, forest, minimumSpanningTree, shortestPathTree and hw4_a .. hw4_d,
+// then run
+//   graphBenchmark [scales, e.g. 12,16] [edge factor] [bin dir] [work dir] [timeout s] > results.csv
+
+// Edge file layout of graphIO.cpp: EdgeFileHeader (48 bytes) | FileEdge[edgeCount]
+struct EdgeFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t vertexCount;
+    uint64_t edgeCount;
+    uint64_t edgeOffset;
+    uint64_t fileSize;
+};
+
+struct FileEdge {
+    uint32_t u;
+    uint32_t v;
+    int32_t w;
+};
+
+struct SyntheticGraph {
+    std::string name;
+    uint32_t n;
+    std::vector<FileEdge> edges;
+};
+
+// Every generator is seeded from its name and scale, so a graph is the same on every run
+
+// G(n, m): m edges with uniformly random endpoints, self-loops redrawn
+SyntheticGraph erdosRenyi(int scale, int edgeFactor) {
+    SyntheticGraph g{"erdos-renyi", 1u << scale, {}};
+    std::mt19937 rng(1000 + scale);
+    g.edges.reserve(static_cast<size_t>(g.n) * edgeFactor);
+    while (g.edges.size() < static_cast<size_t>(g.n) * edgeFactor) {
+        uint32_t u{static_cast<uint32_t>(rng() % g.n)};
+        uint32_t v{static_cast<uint32_t>(rng() % g.n)};
+        if (u != v) {
+            g.edges.push_back({u, v, static_cast<int32_t>(rng() % 1000) + 1});
+        }
+    }
+    return g;
+}
+
+// R-MAT with the Graph500 probabilities (a, b, c, d) = (0.57, 0.19, 0.19, 0.05): each edge
+// picks one quadrant of the adjacency matrix per bit, which gives a skewed, power-law-like
+// degree distribution. Vertex ids are shuffled so the hubs are not all near 0, except the
+// largest hub, which stays 0 so that searches from vertex 0 start in the giant component.
+SyntheticGraph rmat(int scale, int edgeFactor) {
+    SyntheticGraph g{"rmat", 1u << scale, {}};
+    std::mt19937 rng(2000 + scale);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::vector<uint32_t> label(g.n);
+    std::iota(label.begin(), label.end(), 0);
+    std::shuffle(label.begin() + 1, label.end(), rng);
+
+    g.edges.reserve(static_cast<size_t>(g.n) * edgeFactor);
+    while (g.edges.size() < static_cast<size_t>(g.n) * edgeFactor) {
+        uint32_t u{0};
+        uint32_t v{0};
+        for (int bit{0}; bit < scale; bit++) {
+            double p{coin(rng)};
+            u = (u << 1) | (p >= 0.76 ? 1 : 0);
+            v = (v << 1) | ((p >= 0.57 && p < 0.76) || p >= 0.95 ? 1 : 0);
+        }
+        if (u != v) {
+            g.edges.push_back({label[u], label[v], static_cast<int32_t>(rng() % 1000) + 1});
+        }
+    }
+    return g;
+}
+
+// Rows x columns lattice with 4-neighbour edges and random weights
+SyntheticGraph grid(int scale) {
+    SyntheticGraph g{"grid", 1u << scale, {}};
+    std::mt19937 rng(3000 + scale);
+    uint32_t columns{1u << (scale / 2)};
+    uint32_t rows{g.n / columns};
+    for (uint32_t r{0}; r < rows; r++) {
+        for (uint32_t c{0}; c < columns; c++) {
+            uint32_t v{r * columns + c};
+            if (c + 1 < columns) {
+                g.edges.push_back({v, v + 1, static_cast<int32_t>(rng() % 100) + 1});
+            }
+            if (r + 1 < rows) {
+                g.edges.push_back({v, v + columns, static_cast<int32_t>(rng() % 100) + 1});
+            }
+        }
+    }
+    return g;
+}
+
+// Road-network stand-in: a lattice where every 8th row and column is a fast arterial that
+// is always present, the local streets in between are kept with probability 0.6 and cost
+// more, and a few diagonal shortcuts are added. Average degree is close to 2.5, like real
+// road graphs, and the ids follow the lattice, so neighbours are mostly close in memory.
+SyntheticGraph roadLike(int scale) {
+    SyntheticGraph g{"road", 1u << scale, {}};
+    std::mt19937 rng(4000 + scale);
+    uint32_t columns{1u << (scale / 2)};
+    uint32_t rows{g.n / columns};
+    for (uint32_t r{0}; r < rows; r++) {
+        for (uint32_t c{0}; c < columns; c++) {
+            uint32_t v{r * columns + c};
+            if (c + 1 < columns && (r % 8 == 0 || rng() % 10 < 6)) {
+                g.edges.push_back({v, v + 1, static_cast<int32_t>(r % 8 == 0 ? 10 + rng() % 10 : 40 + rng() % 60)});
+            }
+            if (r + 1 < rows && (c % 8 == 0 || rng() % 10 < 6)) {
+                g.edges.push_back({v, v + columns, static_cast<int32_t>(c % 8 == 0 ? 10 + rng() % 10 : 40 + rng() % 60)});
+            }
+            if (c + 1 < columns && r + 1 < rows && rng() % 50 == 0) {
+                g.edges.push_back({v, v + columns + 1, static_cast<int32_t>(60 + rng() % 80)});
+            }
+        }
+    }
+    return g;
+}
+
+// Random recursive tree with shuffled ids: the worst case for forest detection, which has
+// to look at every edge before it can answer yes
+SyntheticGraph randomTree(int scale) {
+    SyntheticGraph g{"tree", 1u << scale, {}};
+    std::mt19937 rng(5000 + scale);
+    std::vector<uint32_t> label(g.n);
+    std::iota(label.begin(), label.end(), 0);
+    std::shuffle(label.begin(), label.end(), rng);
+
+    g.edges.reserve(g.n - 1);
+    for (uint32_t v{1}; v < g.n; v++) {
+        g.edges.push_back({label[v], label[rng() % v], static_cast<int32_t>(rng() % 1000) + 1});
+    }
+    return g;
+}
+
+bool writeEdgeFile(const std::string &path, const SyntheticGraph &g) {
+    EdgeFileHeader header{};
+    std::memcpy(header.magic, "NDHUEDG1", 8);
+    header.version = 1;
+    header.vertexCount = g.n;
+    header.edgeCount = g.edges.size();
+    header.edgeOffset = sizeof(EdgeFileHeader);
+    header.fileSize = sizeof(EdgeFileHeader) + g.edges.size() * sizeof(FileEdge);
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(g.edges.data()), g.edges.size() * sizeof(FileEdge));
+    return static_cast<bool>(out);
+}
+
+// Stdin layouts of the HW4 programs: "N M", optionally the N vertex labels, then M edges
+enum InputKind { EDGE_FILE, PAIRS_WITH_LABELS, TRIPLES, TRIPLES_WITH_LABELS };
+
+bool writeTextFile(const std::string &path, const SyntheticGraph &g, InputKind kind) {
+    std::ofstream out(path);
+    out << g.n << " " << g.edges.size() << "\n";
+    if (kind == PAIRS_WITH_LABELS || kind == TRIPLES_WITH_LABELS) {
+        for (uint32_t v{0}; v < g.n; v++) {
+            out << v << "\n";
+        }
+    }
+    for (const FileEdge &e : g.edges) {
+        out << e.u << " " << e.v;
+        if (kind != PAIRS_WITH_LABELS) {
+            out << " " << e.w;
+        }
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+struct Implementation {
+    std::string program;
+    std::string algorithm;
+    InputKind input;
+    // Larger graphs are reported as skipped, the HW4 programs keep a V x V bit matrix and
+    // look vertices up linearly
+    uint32_t maxVertices;
+};
+
+const std::vector<Implementation> IMPLEMENTATIONS{
+    {"csrGraph", "bfs", EDGE_FILE, UINT32_MAX},
+    {"csrGraph", "dfs", EDGE_FILE, UINT32_MAX},
+    {"csrGraph", "dijkstra", EDGE_FILE, UINT32_MAX},
+    {"csrGraph", "mst", EDGE_FILE, UINT32_MAX},
+    {"DFS_BFS", "bfs", EDGE_FILE, UINT32_MAX},
+    {"DFS_BFS", "dfs", EDGE_FILE, UINT32_MAX},
+    {"forest", "forest", EDGE_FILE, UINT32_MAX},
+    {"forest", "stream", EDGE_FILE, UINT32_MAX},
+    {"minimumSpanningTree", "prim", EDGE_FILE, UINT32_MAX},
+    {"minimumSpanningTree", "boruvka", EDGE_FILE, UINT32_MAX},
+    {"minimumSpanningTree", "lab4-prim", EDGE_FILE, UINT32_MAX},
+    {"minimumSpanningTree", "lab4-kruskal", EDGE_FILE, UINT32_MAX},
+    {"shortestPathTree", "dijkstra", EDGE_FILE, UINT32_MAX},
+    {"hw4_d", "delta-stepping", EDGE_FILE, UINT32_MAX},
+    {"hw4_a", "bfs+dfs", PAIRS_WITH_LABELS, 1u << 13},
+    {"hw4_b", "kruskal", TRIPLES, 1u << 13},
+    {"hw4_c", "prim", TRIPLES, 1u << 13},
+    {"hw4_d", "dijkstra", TRIPLES_WITH_LABELS, 1u << 13},
+};
+
+struct RunResult {
+    double wallMs;
+    long peakKb;
+    std::string status;
+};
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs args[0] with stdin from input (if not empty) and stdout into output, killing it
+// after timeout seconds. Peak memory is the child's ru_maxrss.
+RunResult runChild(const std::vector<std::string> &args, const std::string &input, const std::string &output, double timeout) {
+    std::vector<char *> argv;
+    for (const std::string &arg : args) {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    pid_t pid{fork()};
+    if (pid < 0) {
+        return {0, 0, "fork failed"};
+    }
+    if (pid == 0) {
+        int in{input.empty() ? open("/dev/null", O_RDONLY) : open(input.c_str(), O_RDONLY)};
+        int out{open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+        if (in < 0 || out < 0) {
+            _exit(126);
+        }
+        dup2(in, STDIN_FILENO);
+        dup2(out, STDOUT_FILENO);
+        close(in);
+        close(out);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+
+    int status{0};
+    struct rusage usage{};
+    bool killed{false};
+    while (wait4(pid, &status, WNOHANG, &usage) == 0) {
+        if (elapsedSince(start) > timeout * 1000) {
+            kill(pid, SIGKILL);
+            wait4(pid, &status, 0, &usage);
+            killed = true;
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    RunResult result{elapsedSince(start), usage.ru_maxrss, "ok"};
+    if (killed) {
+        result.status = "timeout";
+    } else if (WIFSIGNALED(status)) {
+        result.status = "signal " + std::to_string(WTERMSIG(status));
+    } else if (WEXITSTATUS(status) != 0) {
+        result.status = "exit " + std::to_string(WEXITSTATUS(status));
+    }
+    return result;
+}
+
+// Last line of a run mode's output: algorithm,ms,checksum
+bool parseRunLine(const std::string &path, double &ms, std::string &checksum) {
+    std::ifstream in(path);
+    std::string line;
+    std::string last;
+    while (std::getline(in, line)) {
+        if (!line.empty()) {
+            last = line;
+        }
+    }
+
+    std::stringstream fields(last);
+    std::string algorithm;
+    std::string time;
+    if (!std::getline(fields, algorithm, ',') || !std::getline(fields, time, ',') || !std::getline(fields, checksum)) {
+        return false;
+    }
+    ms = std::atof(time.c_str());
+    return true;
+}
+
+void benchmarkGraph(const SyntheticGraph &g, const std::string &binDir, const std::string &workDir, double timeout) {
+    std::string base{workDir + "/" + g.name + "-" + std::to_string(g.n)};
+    std::string output{base + ".out"};
+    std::vector<std::string> written;
+
+    for (const Implementation &impl : IMPLEMENTATIONS) {
+        std::string program{binDir + "/" + impl.program};
+        std::cout << g.name << "," << g.n << "," << g.edges.size() << "," << impl.program << "," << impl.algorithm << ",";
+
+        if (g.n > impl.maxVertices) {
+            std::cout << ",,,,,skipped" << std::endl;
+            continue;
+        }
+        if (access(program.c_str(), X_OK) != 0) {
+            std::cout << ",,,,,missing" << std::endl;
+            continue;
+        }
+
+        std::string input{base + (impl.input == EDGE_FILE ? ".edges" : ".txt" + std::to_string(impl.input))};
+        if (std::find(written.begin(), written.end(), input) == written.end()) {
+            bool ok{impl.input == EDGE_FILE ? writeEdgeFile(input, g) : writeTextFile(input, g, impl.input)};
+            if (!ok) {
+                std::cout << ",,,,,write failed" << std::endl;
+                continue;
+            }
+            written.push_back(input);
+        }
+
+        std::cerr << g.name << " (" << g.n << " vertices): " << impl.program << " " << impl.algorithm << std::endl;
+        RunResult run{impl.input == EDGE_FILE ? runChild({program, "run", input, impl.algorithm}, "", output, timeout)
+                                              : runChild({program}, input, output, timeout)};
+
+        // Run modes time the algorithm alone; the HW4 programs only have the wall time,
+        // which includes reading the text input and printing the result
+        double ms{run.wallMs};
+        std::string checksum;
+        bool timed{impl.input == EDGE_FILE && run.status == "ok" && parseRunLine(output, ms, checksum)};
+        double edgesPerSecond{ms > 0 ? g.edges.size() / (ms / 1000) : 0};
+
+        std::cout << run.wallMs << "," << (timed ? std::to_string(ms) : "") << "," << (run.status == "ok" ? std::to_string(static_cast<long long>(edgesPerSecond)) : "")
+                  << "," << run.peakKb << "," << checksum << "," << run.status << std::endl;
+    }
+
+    written.push_back(output);
+    for (const std::string &path : written) {
+        std::remove(path.c_str());
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string scales{argc > 1 ? argv[1] : "12,16"};
+    int edgeFactor{argc > 2 ? std::atoi(argv[2]) : 8};
+    std::string binDir{argc > 3 ? argv[3] : "."};
+    std::string workDir{argc > 4 ? argv[4] : "/tmp"};
+    double timeout{argc > 5 ? std::atof(argv[5]) : 60};
+
+    std::cout << "graph,vertices,edges,implementation,algorithm,wall_ms,algorithm_ms,edges_per_sec,peak_rss_kb,checksum,status" << std::endl;
+
+    std::stringstream list(scales);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        int scale{std::atoi(item.c_str())};
+        if (scale < 2 || scale > 30) {
+            std::cerr << "Scale must be between 2 and 30: " << item << std::endl;
+            return 1;
+        }
+
+        benchmarkGraph(erdosRenyi(scale, edgeFactor), binDir, workDir, timeout);
+        benchmarkGraph(rmat(scale, edgeFactor), binDir, workDir, timeout);
+        benchmarkGraph(grid(scale), binDir, workDir, timeout);
+        benchmarkGraph(roadLike(scale), binDir, workDir, timeout);
+        benchmarkGraph(randomTree(scale), binDir, workDir, timeout);
+    }
+}
@@ -0,0 +1,476 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// On-disk layout: EdgeFileHeader (48 bytes) | FileEdge[edgeCount], packed back to back.
+// Endpoints are 0-based and below vertexCount.
+struct EdgeFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t vertexCount;
+    uint64_t edgeCount;
+    uint64_t edgeOffset;
+    uint64_t fileSize;
+};
+
+struct FileEdge {
+    uint32_t u;
+    uint32_t v;
+    int32_t w;
+};
+
+static_assert(sizeof(FileEdge) == 12, "edges are stored as packed u32/u32/i32 triples");
+
+const char EDGE_MAGIC[8]{'N', 'D', 'H', 'U', 'E', 'D', 'G', '1'};
+
+// Runs f(lo, hi) on `threads` contiguous slices of [0, n), inline when threads is 1
+template <class F>
+void parallelFor(uint64_t n, int threads, F f) {
+    if (threads <= 1 || n < 2) {
+        f(uint64_t{0}, n);
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    uint64_t chunk{(n + threads - 1) / threads};
+    for (uint64_t lo{0}; lo < n; lo += chunk) {
+        pool.emplace_back(f, lo, std::min(n, lo + chunk));
+    }
+    for (std::thread &t : pool) {
+        t.join();
+    }
+}
+
+// In-place exclusive prefix sum: every thread sums its slice, the slice totals are scanned,
+// then every thread rescans its slice starting from its total
+void parallelPrefixSum(std::vector<uint64_t> &a, int threads) {
+    uint64_t n{a.size()};
+    int parts{n < (1u << 16) ? 1 : threads};
+    uint64_t chunk{(n + parts - 1) / parts};
+    std::vector<uint64_t> start(parts + 1, 0);
+
+    parallelFor(parts, parts, [&](uint64_t lo, uint64_t hi) {
+        for (uint64_t t{lo}; t < hi; t++) {
+            uint64_t sum{0};
+            for (uint64_t j{t * chunk}; j < std::min(n, (t + 1) * chunk); j++) {
+                sum += a[j];
+            }
+            start[t + 1] = sum;
+        }
+    });
+    for (int t{0}; t < parts; t++) {
+        start[t + 1] += start[t];
+    }
+
+    parallelFor(parts, parts, [&](uint64_t lo, uint64_t hi) {
+        for (uint64_t t{lo}; t < hi; t++) {
+            uint64_t sum{start[t]};
+            for (uint64_t j{t * chunk}; j < std::min(n, (t + 1) * chunk); j++) {
+                uint64_t value{a[j]};
+                a[j] = sum;
+                sum += value;
+            }
+        }
+    });
+}
+
+// Streams edges to disk through a fixed buffer; the header is written last, once the
+// counts are known, so any number of edges fits in constant memory
+class EdgeListWriter {
+  public:
+    EdgeListWriter() : file(nullptr), vertices(0), edges(0), failed(false) {}
+
+    EdgeListWriter(const EdgeListWriter &) = delete;
+    EdgeListWriter &operator=(const EdgeListWriter &) = delete;
+
+    ~EdgeListWriter() {
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+    }
+
+    bool open(const std::string &path) {
+        file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+
+        EdgeFileHeader header{};
+        buffer.reserve(1 << 16);
+        vertices = edges = 0;
+        failed = false;
+        return std::fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+
+    void add(uint32_t u, uint32_t v, int32_t w) {
+        buffer.push_back({u, v, w});
+        vertices = std::max<uint64_t>(vertices, std::max(u, v) + uint64_t{1});
+        edges++;
+        if (buffer.size() == buffer.capacity()) {
+            flush();
+        }
+    }
+
+    // Vertices without edges still count when vertexCount is larger than every endpoint.
+    // Fails if any edge could not be written.
+    bool close(uint64_t vertexCount = 0) {
+        if (file == nullptr) {
+            return false;
+        }
+        flush();
+
+        EdgeFileHeader header{};
+        std::memcpy(header.magic, EDGE_MAGIC, sizeof(EDGE_MAGIC));
+        header.version = 1;
+        header.vertexCount = std::max(vertices, vertexCount);
+        header.edgeCount = edges;
+        header.edgeOffset = sizeof(EdgeFileHeader);
+        header.fileSize = header.edgeOffset + edges * sizeof(FileEdge);
+
+        bool ok{!failed && std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, file) == 1};
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+  private:
+    std::FILE *file;
+    std::vector<FileEdge> buffer;
+    uint64_t vertices;
+    uint64_t edges;
+    bool failed; // a short write happened, reported by close()
+
+    void flush() {
+        if (!buffer.empty()) {
+            failed = failed || std::fwrite(buffer.data(), sizeof(FileEdge), buffer.size(), file) != buffer.size();
+            buffer.clear();
+        }
+    }
+};
+
+// Read-only view of an edge file, read straight from the page cache
+class MappedEdgeList {
+  public:
+    MappedEdgeList() : base(nullptr), length(0), header(nullptr) {}
+
+    MappedEdgeList(const MappedEdgeList &) = delete;
+    MappedEdgeList &operator=(const MappedEdgeList &) = delete;
+
+    ~MappedEdgeList() {
+        close();
+    }
+
+    bool open(const std::string &path) {
+        close();
+
+        int fd{::open(path.c_str(), O_RDONLY)};
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(EdgeFileHeader)) {
+            ::close(fd);
+            return false;
+        }
+
+        length = st.st_size;
+        void *p{mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0)};
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            length = 0;
+            return false;
+        }
+
+        base = static_cast<const char *>(p);
+        header = reinterpret_cast<const EdgeFileHeader *>(base);
+        // Compare counts against the space left so that no product or sum can wrap around
+        if (std::memcmp(header->magic, EDGE_MAGIC, sizeof(EDGE_MAGIC)) != 0 || header->version != 1 || header->fileSize != length ||
+            header->edgeOffset < sizeof(EdgeFileHeader) || header->edgeOffset > length || header->edgeOffset % alignof(FileEdge) != 0 ||
+            header->edgeCount > (length - header->edgeOffset) / sizeof(FileEdge) ||
+            header->edgeOffset + header->edgeCount * sizeof(FileEdge) != length || header->vertexCount > UINT32_MAX) {
+            close();
+            return false;
+        }
+
+        madvise(const_cast<char *>(base), length, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    void close() {
+        if (base != nullptr) {
+            munmap(const_cast<char *>(base), length);
+        }
+        base = nullptr;
+        header = nullptr;
+        length = 0;
+    }
+
+    uint64_t vertexCount() const {
+        return header ? header->vertexCount : 0;
+    }
+
+    uint64_t edgeCount() const {
+        return header ? header->edgeCount : 0;
+    }
+
+    // Points into the mapping and stays valid until close()
+    const FileEdge *edges() const {
+        return reinterpret_cast<const FileEdge *>(base + header->edgeOffset);
+    }
+
+  private:
+    const char *base;
+    size_t length;
+    const EdgeFileHeader *header;
+};
+
+// Adjacency in compressed sparse row form: the arcs of u are arcs[offset[u], offset[u + 1]).
+// Target and weight sit side by side, so placing an arc costs one cache miss, not two.
+struct CSR {
+    struct Arc {
+        uint32_t v;
+        int32_t w;
+    };
+
+    std::vector<uint64_t> offset;
+    std::vector<Arc> arcs;
+};
+
+// Two passes over the edges. The first counts degrees, the prefix sum turns the counts
+// into offsets, and the second drops every arc at its vertex's cursor. With several
+// threads the counters and cursors are bumped atomically, so the order of arcs within a
+// row depends on scheduling. Fails on an endpoint outside [0, n).
+bool buildCSR(const FileEdge *edges, uint64_t m, uint64_t n, bool undirected, int threads, CSR &graph) {
+    std::atomic<bool> valid{true};
+
+    graph.offset.assign(n + 1, 0);
+    parallelFor(m, threads, [&](uint64_t lo, uint64_t hi) {
+        for (uint64_t j{lo}; j < hi; j++) {
+            const FileEdge &e{edges[j]};
+            if (e.u >= n || e.v >= n) {
+                valid = false;
+                return;
+            }
+            if (threads <= 1) {
+                graph.offset[e.u]++;
+                graph.offset[e.v] += undirected && e.u != e.v;
+            } else {
+                __atomic_fetch_add(&graph.offset[e.u], 1, __ATOMIC_RELAXED);
+                if (undirected && e.u != e.v) {
+                    __atomic_fetch_add(&graph.offset[e.v], 1, __ATOMIC_RELAXED);
+                }
+            }
+        }
+    });
+    if (!valid) {
+        return false;
+    }
+    parallelPrefixSum(graph.offset, threads);
+
+    graph.arcs.resize(graph.offset[n]);
+    std::vector<uint64_t> cursor(graph.offset.begin(), graph.offset.end() - 1);
+    parallelFor(m, threads, [&](uint64_t lo, uint64_t hi) {
+        for (uint64_t j{lo}; j < hi; j++) {
+            const FileEdge &e{edges[j]};
+            if (threads <= 1) {
+                graph.arcs[cursor[e.u]++] = {e.v, e.w};
+                if (undirected && e.u != e.v) {
+                    graph.arcs[cursor[e.v]++] = {e.u, e.w};
+                }
+            } else {
+                graph.arcs[__atomic_fetch_add(&cursor[e.u], 1, __ATOMIC_RELAXED)] = {e.v, e.w};
+                if (undirected && e.u != e.v) {
+                    graph.arcs[__atomic_fetch_add(&cursor[e.v], 1, __ATOMIC_RELAXED)] = {e.u, e.w};
+                }
+            }
+        }
+    });
+    return true;
+}
+
+bool buildCSR(const MappedEdgeList &list, bool undirected, int threads, CSR &graph) {
+    return buildCSR(list.edges(), list.edgeCount(), list.vertexCount(), undirected, threads, graph);
+}
+
+// Skips whitespace and reads one integer
+bool parseNext(const char *&cursor, const char *end, int64_t &value) {
+    while (cursor < end && (*cursor == ' ' || *cursor == '\n' || *cursor == '\r' || *cursor == '\t')) {
+        cursor++;
+    }
+    std::from_chars_result result{std::from_chars(cursor, end, value)};
+    cursor = result.ptr;
+    return result.ec == std::errc();
+}
+
+// Reads the text layouts the HW4 programs take from stdin: "N M", then N vertex labels
+// when `listed` (hw4_a, hw4_d), then M edges "u v w", or "u v" with weight 1 when
+// `unweighted` (hw4_a). The text is mapped and parsed in place rather than through
+// std::cin. Returns false on a malformed file.
+bool convertText(const std::string &in, const std::string &out, bool listed, bool unweighted) {
+    int fd{::open(in.c_str(), O_RDONLY)};
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t length{static_cast<size_t>(st.st_size)};
+    void *p{length > 0 ? mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED};
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    madvise(p, length, MADV_SEQUENTIAL);
+
+    const char *cursor{static_cast<const char *>(p)};
+    const char *end{cursor + length};
+    int64_t n;
+    int64_t m;
+    int64_t label;
+    bool ok{parseNext(cursor, end, n) && parseNext(cursor, end, m) && n >= 0 && m >= 0};
+    if (listed) {
+        for (int64_t j{0}; j < n && ok; j++) {
+            ok = parseNext(cursor, end, label);
+        }
+    }
+
+    EdgeListWriter writer;
+    ok = ok && writer.open(out);
+    for (int64_t j{0}; j < m && ok; j++) {
+        int64_t u;
+        int64_t v;
+        int64_t w{1};
+        ok = parseNext(cursor, end, u) && parseNext(cursor, end, v) && (unweighted || parseNext(cursor, end, w));
+        ok = ok && u >= 0 && v >= 0 && u < UINT32_MAX && v < UINT32_MAX && w >= INT32_MIN && w <= INT32_MAX;
+        if (ok) {
+            writer.add(static_cast<uint32_t>(u), static_cast<uint32_t>(v), static_cast<int32_t>(w));
+        }
+    }
+    munmap(p, length);
+    ok = writer.close(ok ? n : 0) && ok;
+    if (!ok) {
+        std::remove(out.c_str());
+    }
+    return ok;
+}
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Writes m random edges over n vertices as hw4_b-style text, then times the way the graph
+// programs ingest it today (std::cin into a vector, then CSR) against convert + mmap load
+int benchmark(uint64_t m, const std::string &prefix) {
+    uint32_t n{static_cast<uint32_t>(std::max<uint64_t>(2, m / 8))};
+    std::string textPath{prefix + ".txt"};
+    std::string binaryPath{prefix + ".edges"};
+    std::mt19937 rng(17);
+
+    {
+        std::ofstream text(textPath);
+        text << n << " " << m << "\n";
+        for (uint64_t j{0}; j < m; j++) {
+            text << rng() % n << " " << rng() % n << " " << 1 + rng() % 1000000 << "\n";
+        }
+    }
+    std::cout << m << " edges, " << n << " vertices" << std::endl;
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    CSR expected;
+    {
+        std::ifstream text(textPath);
+        uint64_t count;
+        uint32_t vertices;
+        text >> vertices >> count;
+        std::vector<FileEdge> parsed(count);
+        for (FileEdge &e : parsed) {
+            text >> e.u >> e.v >> e.w;
+        }
+        buildCSR(parsed.data(), parsed.size(), vertices, true, 1, expected);
+    }
+    std::cout << "std::istream + CSR: " << elapsedSince(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    if (!convertText(textPath, binaryPath, false, false)) {
+        std::cout << "Could not convert " << textPath << std::endl;
+        return 1;
+    }
+    std::cout << "Convert to " << binaryPath << " (once): " << elapsedSince(start) << " ms" << std::endl;
+
+    int cores{static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+    for (int threads{1}; threads <= cores; threads = (threads == cores) ? cores + 1 : std::min(threads * 2, cores)) {
+        start = std::chrono::steady_clock::now();
+        MappedEdgeList list;
+        CSR graph;
+        if (!list.open(binaryPath) || !buildCSR(list, true, threads, graph)) {
+            std::cout << "Could not load " << binaryPath << std::endl;
+            return 1;
+        }
+        double elapsed{elapsedSince(start)};
+
+        // The same arcs per row, possibly in another order with several threads
+        bool same{graph.offset == expected.offset};
+        for (uint64_t u{0}; same && u < n; u++) {
+            std::vector<std::pair<uint32_t, int32_t>> a;
+            std::vector<std::pair<uint32_t, int32_t>> b;
+            for (uint64_t arc{graph.offset[u]}; arc < graph.offset[u + 1]; arc++) {
+                a.push_back({graph.arcs[arc].v, graph.arcs[arc].w});
+                b.push_back({expected.arcs[arc].v, expected.arcs[arc].w});
+            }
+            std::sort(a.begin(), a.end());
+            std::sort(b.begin(), b.end());
+            same = a == b;
+        }
+        std::cout << "mmap + CSR (" << threads << " threads): " << elapsed << " ms, " << graph.arcs.size() << " arcs" << (same ? "" : " MISMATCH") << std::endl;
+    }
+
+    std::remove(textPath.c_str());
+    std::remove(binaryPath.c_str());
+    return 0;
+}
+
+// "convert <text> <edges> [--listed] [--unweighted]" converts one file; otherwise
+// "[edges] [path prefix]" runs the ingestion benchmark
+int main(int argc, char *argv[]) {
+    if (argc > 3 && std::string(argv[1]) == "convert") {
+        bool listed{false};
+        bool unweighted{false};
+        for (int j{4}; j < argc; j++) {
+            listed = listed || std::string(argv[j]) == "--listed";
+            unweighted = unweighted || std::string(argv[j]) == "--unweighted";
+        }
+        if (!convertText(argv[2], argv[3], listed, unweighted)) {
+            std::cout << "Could not convert " << argv[2] << std::endl;
+            return 1;
+        }
+
+        MappedEdgeList list;
+        list.open(argv[3]);
+        std::cout << argv[3] << ": " << list.vertexCount() << " vertices, " << list.edgeCount() << " edges" << std::endl;
+        return 0;
+    }
+
+    uint64_t m{argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000000};
+    return benchmark(m, argc > 2 ? argv[2] : "graph");
+}
@@ -0,0 +1,554 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+template <class T>
+class Node {
+  public:
+    Node() : data(std::make_shared<T>()) {}
+
+    Node(T d) : data(std::make_shared<T>(d)) {}
+
+    Node &operator=(T d) {
+        *data = d;
+        return *this;
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, const Node &n) {
+        out << *(n.data);
+        return out;
+    }
+
+    void setData(T d) {
+        *data = d;
+    }
+
+    T &getData() const {
+        return *data;
+    }
+
+  protected:
+    std::shared_ptr<T> data;
+};
+
+template <class T>
+class ListNode : public Node<T> {
+  public:
+    ListNode() : Node<T>(), prev(nullptr), next(nullptr) {}
+
+    ListNode(T d) : Node<T>(d), prev(nullptr), next(nullptr) {}
+
+    std::shared_ptr<ListNode> getNext() const {
+        return next;
+    }
+
+    std::shared_ptr<ListNode> getPrev() const {
+        return prev;
+    }
+
+    void setNext(std::shared_ptr<ListNode> n) {
+        next = n;
+    }
+
+    void setPrev(std::shared_ptr<ListNode> p) {
+        prev = p;
+    }
+
+    ListNode &operator=(T d) {
+        this->setData(d);
+        return *this;
+    }
+
+  private:
+    std::shared_ptr<ListNode> prev, next;
+    // The IndexedLinkList holding the node and its treap entry there, if any
+    const void *owner{nullptr};
+    uint32_t slot{0};
+
+    template <class U>
+    friend class IndexedLinkList;
+};
+
+// The week9 list, whose operator[] the graph code calls in loops; kept as the benchmark baseline
+template <class T>
+class LinkList {
+  public:
+    LinkList() : head(nullptr), tail(nullptr) {}
+
+    void addFromHead(T d) {
+        std::shared_ptr<ListNode<T>> node{std::make_shared<ListNode<T>>(d)};
+        if (head != nullptr) {
+            head->setPrev(node);
+        }
+        node->setNext(head);
+        head = node;
+        if (tail == nullptr) {
+            tail = node;
+        }
+    }
+
+    void addFromTail(T d) {
+        std::shared_ptr<ListNode<T>> node{std::make_shared<ListNode<T>>(d)};
+        if (tail != nullptr) {
+            tail->setNext(node);
+        }
+
+        node->setPrev(tail);
+        tail = node;
+        if (head == nullptr) {
+            head = node;
+        }
+    }
+
+    ListNode<T> &operator[](int i) {
+        std::shared_ptr<ListNode<T>> current{head};
+        for (int k{0}; k < i && current != nullptr; k++) {
+            current = current->getNext();
+        }
+
+        if (current == nullptr) {
+            throw std::invalid_argument("Index does not exist.");
+        }
+        return *current;
+    }
+
+    void print() const {
+        std::shared_ptr<ListNode<T>> current{head};
+        while (current != nullptr) {
+            std::cout << *current << " ";
+            current = current->getNext();
+        }
+        std::cout << std::endl;
+    }
+
+  private:
+    std::shared_ptr<ListNode<T>> head, tail;
+};
+
+// Drop-in replacement for LinkList: the same members and the same shared_ptr<ListNode>
+// nodes, so users switch by changing the type. Besides the prev/next links every node is
+// kept in an implicit treap ordered by list position, where every entry stores its
+// subtree size, and the node remembers its owner and treap entry. operator[], indexOf,
+// insertion and removal are O(log n) expected, exist(node) is O(1) instead of a walk, and
+// following getNext()/getPrev() stays O(1) per step.
+template <class T>
+class IndexedLinkList {
+  public:
+    IndexedLinkList() : head(nullptr), tail(nullptr), root(NIL), freeHead(NIL), seed(0x9e3779b9u) {}
+
+    IndexedLinkList(const IndexedLinkList &) = delete;
+    IndexedLinkList &operator=(const IndexedLinkList &) = delete;
+
+    ~IndexedLinkList() {
+        clear();
+    }
+
+    std::shared_ptr<ListNode<T>> addFromHead(T d) {
+        std::shared_ptr<ListNode<T>> node{std::make_shared<ListNode<T>>(d)};
+        uint32_t entry{allocate(node)};
+        if (head == nullptr) {
+            root = entry;
+        } else {
+            attach(entry, head->slot, true);
+        }
+        link(node, nullptr, head);
+        bubbleUp(entry);
+        return node;
+    }
+
+    std::shared_ptr<ListNode<T>> addFromTail(T d) {
+        std::shared_ptr<ListNode<T>> node{std::make_shared<ListNode<T>>(d)};
+        uint32_t entry{allocate(node)};
+        if (tail == nullptr) {
+            root = entry;
+        } else {
+            attach(entry, tail->slot, false);
+        }
+        link(node, tail, nullptr);
+        bubbleUp(entry);
+        return node;
+    }
+
+    std::shared_ptr<ListNode<T>> addAfter(std::shared_ptr<ListNode<T>> node, T d) {
+        if (!exist(node)) {
+            return nullptr;
+        }
+
+        // The in-order successor of node is either its new right child or the new left
+        // child of its current successor, which has no left child of its own
+        std::shared_ptr<ListNode<T>> newNode{std::make_shared<ListNode<T>>(d)};
+        uint32_t entry{allocate(newNode)};
+        if (slots[node->slot].right == NIL) {
+            attach(entry, node->slot, false);
+        } else {
+            attach(entry, node->getNext()->slot, true);
+        }
+        link(newNode, node, node->getNext());
+        bubbleUp(entry);
+        return newNode;
+    }
+
+    std::shared_ptr<ListNode<T>> removeFromHead() {
+        return remove(head);
+    }
+
+    std::shared_ptr<ListNode<T>> removeFromTail() {
+        return remove(tail);
+    }
+
+    std::shared_ptr<ListNode<T>> remove(std::shared_ptr<ListNode<T>> node) {
+        if (!exist(node)) {
+            return nullptr;
+        }
+        erase(node);
+        return node;
+    }
+
+    bool exist(std::shared_ptr<ListNode<T>> node) const {
+        return node != nullptr && node->owner == this;
+    }
+
+    std::shared_ptr<ListNode<T>> exist(T d) const {
+        for (std::shared_ptr<ListNode<T>> j{head}; j != nullptr; j = j->getNext()) {
+            if (j->getData() == d) {
+                return j;
+            }
+        }
+        return nullptr;
+    }
+
+    // Same exception as the week9 LinkList so the graph loops that catch it keep working
+    ListNode<T> &operator[](int n) const {
+        return *slots[at(n)].node;
+    }
+
+    std::shared_ptr<ListNode<T>> nodeAt(int n) const {
+        return slots[at(n)].node;
+    }
+
+    int indexOf(std::shared_ptr<ListNode<T>> node) const {
+        if (!exist(node)) {
+            return -1;
+        }
+
+        uint32_t j{node->slot};
+        int index{static_cast<int>(sizeOf(slots[j].left))};
+        while (slots[j].parent != NIL) {
+            uint32_t parent{slots[j].parent};
+            if (slots[parent].right == j) {
+                index += sizeOf(slots[parent].left) + 1;
+            }
+            j = parent;
+        }
+        return index;
+    }
+
+    template <class F>
+    void forEach(F f) const {
+        for (std::shared_ptr<ListNode<T>> current{head}; current != nullptr; current = current->getNext()) {
+            f(current->getData());
+        }
+    }
+
+    int size() const {
+        return sizeOf(root);
+    }
+
+    // Unlinks every node, so nodes still held outside the list do not keep each other alive
+    void clear() {
+        for (std::shared_ptr<ListNode<T>> j{head}; j != nullptr;) {
+            std::shared_ptr<ListNode<T>> next{j->getNext()};
+            j->setPrev(nullptr);
+            j->setNext(nullptr);
+            j->owner = nullptr;
+            j = next;
+        }
+        head = tail = nullptr;
+        slots.clear();
+        root = freeHead = NIL;
+    }
+
+    void print() const {
+        std::shared_ptr<ListNode<T>> current{head};
+        while (current != nullptr) {
+            std::cout << *current << " ";
+            current = current->getNext();
+        }
+        std::cout << std::endl;
+    }
+
+    std::shared_ptr<ListNode<T>> head;
+    std::shared_ptr<ListNode<T>> tail;
+
+  private:
+    static constexpr uint32_t NIL{UINT32_MAX};
+
+    // Treap entry of one node; priority is a min-heap key. Free entries are chained
+    // through parent.
+    struct Slot {
+        std::shared_ptr<ListNode<T>> node;
+        uint32_t left;
+        uint32_t right;
+        uint32_t parent;
+        uint32_t size;
+        uint32_t priority;
+    };
+
+    std::vector<Slot> slots;
+    uint32_t root;
+    uint32_t freeHead;
+    uint32_t seed;
+
+    uint32_t sizeOf(uint32_t entry) const {
+        return entry == NIL ? 0 : slots[entry].size;
+    }
+
+    uint32_t random() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    uint32_t allocate(const std::shared_ptr<ListNode<T>> &node) {
+        uint32_t entry{freeHead};
+        if (entry != NIL) {
+            freeHead = slots[entry].parent;
+        } else {
+            entry = slots.size();
+            slots.push_back({});
+        }
+
+        slots[entry] = {node, NIL, NIL, NIL, 1, random()};
+        node->owner = this;
+        node->slot = entry;
+        return entry;
+    }
+
+    void release(uint32_t entry) {
+        slots[entry].node->owner = nullptr;
+        slots[entry].node = nullptr;
+        slots[entry].parent = freeHead;
+        freeHead = entry;
+    }
+
+    uint32_t at(int n) const {
+        if (n < 0 || n >= size()) {
+            throw std::invalid_argument("Index does not exist.");
+        }
+
+        uint32_t j{root};
+        uint32_t k{static_cast<uint32_t>(n)};
+        while (true) {
+            uint32_t leftSize{sizeOf(slots[j].left)};
+            if (k < leftSize) {
+                j = slots[j].left;
+            } else if (k == leftSize) {
+                return j;
+            } else {
+                k -= leftSize + 1;
+                j = slots[j].right;
+            }
+        }
+    }
+
+    void link(std::shared_ptr<ListNode<T>> node, std::shared_ptr<ListNode<T>> prev, std::shared_ptr<ListNode<T>> next) {
+        node->setPrev(prev);
+        node->setNext(next);
+        if (prev == nullptr) {
+            head = node;
+        } else {
+            prev->setNext(node);
+        }
+        if (next == nullptr) {
+            tail = node;
+        } else {
+            next->setPrev(node);
+        }
+    }
+
+    // Hang a fresh leaf under parent and account for it on the path to the root
+    void attach(uint32_t entry, uint32_t parent, bool asLeft) {
+        (asLeft ? slots[parent].left : slots[parent].right) = entry;
+        slots[entry].parent = parent;
+        for (uint32_t j{parent}; j != NIL; j = slots[j].parent) {
+            slots[j].size++;
+        }
+    }
+
+    void replaceChild(uint32_t parent, uint32_t oldChild, uint32_t newChild) {
+        if (parent == NIL) {
+            root = newChild;
+        } else if (slots[parent].left == oldChild) {
+            slots[parent].left = newChild;
+        } else {
+            slots[parent].right = newChild;
+        }
+    }
+
+    // Lift entry above its parent, keeping in-order position and subtree sizes
+    void rotateUp(uint32_t entry) {
+        uint32_t parent{slots[entry].parent};
+        uint32_t grand{slots[parent].parent};
+
+        if (slots[parent].left == entry) {
+            slots[parent].left = slots[entry].right;
+            if (slots[entry].right != NIL) {
+                slots[slots[entry].right].parent = parent;
+            }
+            slots[entry].right = parent;
+        } else {
+            slots[parent].right = slots[entry].left;
+            if (slots[entry].left != NIL) {
+                slots[slots[entry].left].parent = parent;
+            }
+            slots[entry].left = parent;
+        }
+
+        slots[parent].parent = entry;
+        slots[entry].parent = grand;
+        replaceChild(grand, parent, entry);
+
+        slots[parent].size = sizeOf(slots[parent].left) + sizeOf(slots[parent].right) + 1;
+        slots[entry].size = sizeOf(slots[entry].left) + sizeOf(slots[entry].right) + 1;
+    }
+
+    void bubbleUp(uint32_t entry) {
+        while (slots[entry].parent != NIL && slots[entry].priority < slots[slots[entry].parent].priority) {
+            rotateUp(entry);
+        }
+    }
+
+    void erase(std::shared_ptr<ListNode<T>> node) {
+        // Rotate the entry down to a leaf, then cut it off
+        uint32_t entry{node->slot};
+        while (slots[entry].left != NIL || slots[entry].right != NIL) {
+            uint32_t left{slots[entry].left};
+            uint32_t right{slots[entry].right};
+            if (right == NIL || (left != NIL && slots[left].priority < slots[right].priority)) {
+                rotateUp(left);
+            } else {
+                rotateUp(right);
+            }
+        }
+
+        uint32_t parent{slots[entry].parent};
+        replaceChild(parent, entry, NIL);
+        for (uint32_t j{parent}; j != NIL; j = slots[j].parent) {
+            slots[j].size--;
+        }
+
+        std::shared_ptr<ListNode<T>> prev{node->getPrev()};
+        std::shared_ptr<ListNode<T>> next{node->getNext()};
+        if (prev == nullptr) {
+            head = next;
+        } else {
+            prev->setNext(next);
+        }
+        if (next == nullptr) {
+            tail = prev;
+        } else {
+            next->setPrev(prev);
+        }
+        node->setPrev(nullptr);
+        node->setNext(nullptr);
+        release(entry);
+    }
+};
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The graph access pattern: for (k = 0;; k++) list[k] until the index runs out. The same
+// code compiles for LinkList and IndexedLinkList, which is what makes the latter a drop-in.
+template <class List>
+void indexedLoop(const char *name, int n) {
+    List list;
+    for (int j{0}; j < n; j++) {
+        list.addFromTail(j);
+    }
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    long long sum{0};
+    for (int k{0};; k++) {
+        try {
+            sum += list[k].getData();
+        } catch (const std::invalid_argument &) {
+            break;
+        }
+    }
+    std::cout << "  " << name << elapsedSince(start) << " ms (sum " << sum << ")" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    IndexedLinkList<int> list;
+    std::shared_ptr<ListNode<int>> two{list.addFromTail(2)};
+    list.addFromHead(1);
+    list.addFromTail(5);
+    std::shared_ptr<ListNode<int>> three{list.addAfter(two, 3)};
+    list.addAfter(three, 4);
+    list.print();
+    std::cout << "list[3] = " << list[3] << ", index of 3 = " << list.indexOf(three) << std::endl;
+
+    list.remove(two);
+    std::cout << "After removing 2: ";
+    list.print();
+    std::cout << "Node 2 still in the list: " << (list.exist(two) ? "yes" : "no") << std::endl;
+
+    try {
+        list[10];
+    } catch (const std::invalid_argument &e) {
+        std::cout << "list[10]: " << e.what() << std::endl;
+    }
+
+    int n{argc > 1 ? std::atoi(argv[1]) : 20000};
+    std::cout << "Indexed loop over " << n << " elements:" << std::endl;
+    indexedLoop<LinkList<int>>("LinkList        ", n);
+    indexedLoop<IndexedLinkList<int>>("IndexedLinkList ", n);
+
+    // Random positional inserts and removals, checked against std::vector
+    IndexedLinkList<int> indexed;
+    std::vector<int> reference;
+    std::srand(42);
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    for (int j{0}; j < n; j++) {
+        int op{std::rand() % 6};
+        if (op == 0 && !reference.empty()) {
+            int k{std::rand() % static_cast<int>(reference.size())};
+            indexed.remove(indexed.nodeAt(k));
+            reference.erase(reference.begin() + k);
+        } else if (op == 1 && !reference.empty()) {
+            int k{std::rand() % static_cast<int>(reference.size())};
+            indexed.addAfter(indexed.nodeAt(k), j);
+            reference.insert(reference.begin() + k + 1, j);
+        } else if (op == 2) {
+            indexed.addFromHead(j);
+            reference.insert(reference.begin(), j);
+        } else if (op == 3 && !reference.empty()) {
+            indexed.removeFromHead();
+            reference.erase(reference.begin());
+        } else if (op == 4 && !reference.empty()) {
+            indexed.removeFromTail();
+            reference.pop_back();
+        } else {
+            indexed.addFromTail(j);
+            reference.push_back(j);
+        }
+    }
+    double elapsed{elapsedSince(start)};
+
+    bool same{static_cast<int>(reference.size()) == indexed.size()};
+    int k{0};
+    for (std::shared_ptr<ListNode<int>> j{indexed.head}; same && j != nullptr; j = j->getNext(), k++) {
+        same = (j->getData() == reference[k]) && (indexed[k].getData() == reference[k]) && (indexed.indexOf(j) == k);
+    }
+    same = same && k == static_cast<int>(reference.size());
+    std::cout << n << " random positional updates: " << elapsed << " ms, matches std::vector: " << (same ? "yes" : "no") << std::endl;
+}
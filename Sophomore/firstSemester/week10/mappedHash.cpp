@@ -0,0 +1,568 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+template <class T>
+class Node {
+  public:
+    Node() : data(std::make_unique<T>()) {}
+
+    Node(T d) : data(std::make_unique<T>(d)) {}
+
+    Node &operator=(T d) {
+        *data = d;
+        return *this;
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, const Node &n) {
+        out << *(n.data);
+        return out;
+    }
+
+    void setData(T d) {
+        *data = d;
+    }
+
+    T &getData() const {
+        return *data;
+    }
+
+  private:
+    std::unique_ptr<T> data;
+};
+
+template <class T>
+class ListNode : public Node<T> {
+  public:
+    ListNode() : Node<T>(), prev(nullptr), next(nullptr) {}
+
+    ListNode(T d) : Node<T>(d), prev(nullptr), next(nullptr) {}
+
+    ListNode(std::shared_ptr<ListNode<T>> p, std::shared_ptr<ListNode<T>> n)
+        : Node<T>(), prev(p), next(n) {}
+
+    ListNode(T d, std::shared_ptr<ListNode<T>> p, std::shared_ptr<ListNode<T>> n)
+        : Node<T>(d), prev(p), next(n) {}
+
+    std::shared_ptr<ListNode<T>> getNext() const {
+        return next;
+    }
+
+    std::shared_ptr<ListNode<T>> getPrev() const {
+        return prev;
+    }
+
+    void setNext(std::shared_ptr<ListNode<T>> n) {
+        next = n;
+    }
+
+    void setPrev(std::shared_ptr<ListNode<T>> p) {
+        prev = p;
+    }
+
+  private:
+    std::shared_ptr<ListNode<T>> prev;
+    std::shared_ptr<ListNode<T>> next;
+};
+
+template <class T>
+class LinkList {
+  public:
+    LinkList() : head(nullptr), tail(nullptr) {}
+
+    void addFromHead(T d) {
+        std::shared_ptr<ListNode<T>> node{std::make_shared<ListNode<T>>(d)};
+        if (head != nullptr) {
+            head->setPrev(node);
+        }
+
+        node->setNext(head);
+        head = node;
+        if (tail == nullptr) {
+            tail = head;
+        }
+    }
+
+    void addFromTail(T d) {
+        std::shared_ptr<ListNode<T>> node{std::make_shared<ListNode<T>>(d)};
+        if (tail != nullptr) {
+            tail->setNext(node);
+        }
+
+        node->setPrev(tail);
+        tail = node;
+        if (head == nullptr) {
+            head = tail;
+        }
+    }
+
+    void addAfter(std::shared_ptr<ListNode<T>> node, T d) {
+        if (!exist(node)) {
+            return;
+        }
+
+        std::shared_ptr<ListNode<T>> newNode{std::make_shared<ListNode<T>>(d)};
+        if (node->getNext() != nullptr)
+            node->getNext()->setPrev(newNode);
+
+        newNode->setNext(node->getNext());
+        node->setNext(newNode);
+        newNode->setPrev(node);
+
+        if (newNode->getNext() == nullptr)
+            tail = newNode;
+    }
+
+    std::shared_ptr<ListNode<T>> removeFromHead() {
+        std::shared_ptr<ListNode<T>> node{head};
+        if (head != nullptr) {
+            head = head->getNext();
+            if (head != nullptr)
+                head->setPrev(nullptr);
+            else
+                tail = nullptr;
+            node->setNext(nullptr);
+        }
+        return node;
+    }
+
+    std::shared_ptr<ListNode<T>> removeFromTail() {
+        std::shared_ptr<ListNode<T>> node{tail};
+        if (tail != nullptr) {
+            tail = tail->getPrev();
+
+            if (tail != nullptr)
+                tail->setNext(nullptr);
+            else
+                head = nullptr;
+            node->setPrev(nullptr);
+        }
+        return node;
+    }
+
+    std::shared_ptr<ListNode<T>> remove(std::shared_ptr<ListNode<T>> node) {
+        if (!exist(node)) {
+            return nullptr;
+        }
+
+        if (node == head) {
+            return removeFromHead();
+        } else if (node == tail) {
+            return removeFromTail();
+        } else {
+            node->getPrev()->setNext(node->getNext());
+            node->getNext()->setPrev(node->getPrev());
+            node->setPrev(nullptr);
+            node->setNext(nullptr);
+            return node;
+        }
+    }
+
+    bool exist(std::shared_ptr<ListNode<T>> node) {
+        for (std::shared_ptr<ListNode<T>> j{head}; j != nullptr; j = j->getNext()) {
+            if (j == node) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::shared_ptr<ListNode<T>> exist(T d) {
+        for (std::shared_ptr<ListNode<T>> j{head}; j != nullptr; j = j->getNext()) {
+            if (j->getData() == d) {
+                return j;
+            }
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<const ListNode<T>> &operator[](int n) {
+        std::shared_ptr<ListNode<T>> j{head};
+        for (int i{0}; i < n; i++) {
+            if (j == nullptr) {
+                throw std::out_of_range("Index out of range");
+            }
+            j = j->getNext();
+        }
+        return j;
+    }
+
+    void print() const {
+        std::shared_ptr<ListNode<T>> j{head};
+        while (j != nullptr) {
+            std::cout << *j << " ";
+            j = j->getNext();
+        }
+        std::cout << std::endl;
+    }
+
+    std::shared_ptr<ListNode<T>> head;
+    std::shared_ptr<ListNode<T>> tail;
+};
+
+template <class T1, class T2>
+class Hash {
+  public:
+    struct Pair {
+        T1 key;
+        T2 value;
+
+        Pair() {}
+
+        Pair(T1 k, const T2 &v) : key(k), value(v) {}
+
+        Pair(const Pair &other) : key(other.key), value(other.value) {}
+
+        Pair(Pair &&other) : key(std::move(other.key)), value(std::move(other.value)) {}
+    };
+
+    Hash() {
+        for (int j{0}; j < 100; j++) {
+            table[j] = std::make_shared<LinkList<Pair>>();
+        }
+    }
+
+    bool insert(std::shared_ptr<Pair> p) {
+        unsigned int hash{HashFunction(p->key)};
+
+        table[hash]->addFromTail(*p);
+        return true;
+    }
+
+    std::shared_ptr<Pair> search(T1 key) {
+        unsigned int hash{HashFunction(key)};
+
+        for (std::shared_ptr<ListNode<Pair>> current{table[hash]->head}; current != nullptr; current = current->getNext()) {
+            if (current->getData().key == key) {
+                return std::make_shared<Pair>(current->getData());
+            }
+        }
+
+        return nullptr;
+    }
+
+    template <class F>
+    void forEach(F f) const {
+        for (int j{0}; j < 100; j++) {
+            for (std::shared_ptr<ListNode<Pair>> current{table[j]->head}; current != nullptr; current = current->getNext()) {
+                f(current->getData());
+            }
+        }
+    }
+
+  private:
+    std::shared_ptr<LinkList<Pair>> table[100];
+
+    unsigned int HashFunction(T1 key) {
+        unsigned int size{sizeof(T1)};
+
+        char *keyChar = reinterpret_cast<char *>(&key);
+        unsigned int hash{0};
+        for (int i{0}; i < size; i++) {
+            if (i % 2) {
+                hash ^= *keyChar;
+            } else {
+                hash += *keyChar;
+            }
+            keyChar++;
+        }
+
+        return hash % 100;
+    }
+};
+
+// On-disk layout, every section 8-byte aligned:
+//   FileHeader | uint32_t bucketStart[bucketCount + 1] | FileEntry[entryCount] | string bytes
+// Entries of a bucket are contiguous, so a lookup is one bucket read plus a short scan
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t bucketCount;
+    uint64_t entryCount;
+    uint64_t bucketOffset;
+    uint64_t entryOffset;
+    uint64_t stringOffset;
+    uint64_t fileSize;
+};
+
+struct FileEntry {
+    int32_t key;
+    uint32_t length;
+    uint64_t offset;
+};
+
+const char MAGIC[8]{'N', 'D', 'H', 'U', 'H', 'S', 'H', '1'};
+
+// Stable across compilers and runs, unlike std::hash
+uint32_t FileHashFunction(int32_t key) {
+    uint32_t hash{static_cast<uint32_t>(key)};
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bU;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35U;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+uint64_t alignUp(uint64_t n) {
+    return (n + 7) & ~static_cast<uint64_t>(7);
+}
+
+class MappedHashWriter {
+  public:
+    void add(int32_t key, const std::string &value) {
+        keys.push_back(key);
+        offsets.push_back(strings.size());
+        lengths.push_back(static_cast<uint32_t>(value.size()));
+        strings += value;
+    }
+
+    void add(const Hash<int, std::string> &hash) {
+        hash.forEach([this](const Hash<int, std::string>::Pair &p) { add(p.key, p.value); });
+    }
+
+    bool write(const std::string &path) const {
+        uint32_t bucketCount{1};
+        while (bucketCount < keys.size()) {
+            bucketCount <<= 1;
+        }
+
+        // Counting sort of the entries by bucket, stable so the first inserted duplicate still wins
+        std::vector<uint32_t> bucketStart(bucketCount + 1, 0);
+        for (int32_t key : keys) {
+            bucketStart[(FileHashFunction(key) & (bucketCount - 1)) + 1]++;
+        }
+        for (uint32_t j{0}; j < bucketCount; j++) {
+            bucketStart[j + 1] += bucketStart[j];
+        }
+
+        std::vector<FileEntry> entries(keys.size());
+        std::vector<uint32_t> cursor(bucketStart.begin(), bucketStart.end() - 1);
+        for (size_t j{0}; j < keys.size(); j++) {
+            uint32_t bucket{FileHashFunction(keys[j]) & (bucketCount - 1)};
+            entries[cursor[bucket]++] = {keys[j], lengths[j], offsets[j]};
+        }
+
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = 1;
+        header.bucketCount = bucketCount;
+        header.entryCount = keys.size();
+        header.bucketOffset = alignUp(sizeof(FileHeader));
+        header.entryOffset = alignUp(header.bucketOffset + bucketStart.size() * sizeof(uint32_t));
+        header.stringOffset = alignUp(header.entryOffset + entries.size() * sizeof(FileEntry));
+        header.fileSize = header.stringOffset + strings.size();
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+
+        const char zeros[8]{};
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(zeros, header.bucketOffset - sizeof(header));
+        file.write(reinterpret_cast<const char *>(bucketStart.data()), bucketStart.size() * sizeof(uint32_t));
+        file.write(zeros, header.entryOffset - (header.bucketOffset + bucketStart.size() * sizeof(uint32_t)));
+        file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(FileEntry));
+        file.write(zeros, header.stringOffset - (header.entryOffset + entries.size() * sizeof(FileEntry)));
+        file.write(strings.data(), strings.size());
+
+        return static_cast<bool>(file);
+    }
+
+  private:
+    std::vector<int32_t> keys;
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> lengths;
+    std::string strings;
+};
+
+// Read-only view of a table written by MappedHashWriter, queried in place from the page cache
+class MappedHash {
+  public:
+    MappedHash() : base(nullptr), length(0), header(nullptr), buckets(nullptr), entries(nullptr), entryCount(0), strings(nullptr), stringLength(0) {}
+
+    MappedHash(const MappedHash &) = delete;
+    MappedHash &operator=(const MappedHash &) = delete;
+
+    ~MappedHash() {
+        close();
+    }
+
+    bool open(const std::string &path) {
+        close();
+
+        int fd{::open(path.c_str(), O_RDONLY)};
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(FileHeader)) {
+            ::close(fd);
+            return false;
+        }
+
+        length = st.st_size;
+        void *p{mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0)};
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            length = 0;
+            return false;
+        }
+
+        base = static_cast<const char *>(p);
+        header = reinterpret_cast<const FileHeader *>(base);
+        if (!validHeader()) {
+            close();
+            return false;
+        }
+
+        madvise(const_cast<char *>(base), length, MADV_RANDOM);
+        buckets = reinterpret_cast<const uint32_t *>(base + header->bucketOffset);
+        entries = reinterpret_cast<const FileEntry *>(base + header->entryOffset);
+        entryCount = header->entryCount;
+        strings = base + header->stringOffset;
+        stringLength = length - header->stringOffset;
+        return true;
+    }
+
+    void close() {
+        if (base != nullptr) {
+            munmap(const_cast<char *>(base), length);
+        }
+        base = nullptr;
+        header = nullptr;
+        buckets = nullptr;
+        entries = nullptr;
+        strings = nullptr;
+        length = 0;
+        entryCount = 0;
+        stringLength = 0;
+    }
+
+    // The returned view points into the mapping and stays valid until close(). Bucket
+    // bounds and string ranges are checked on use, so a corrupt file reads as a miss
+    // instead of reading outside the mapping, and open() stays O(1).
+    bool search(int32_t key, std::string_view &value) const {
+        if (header == nullptr) {
+            return false;
+        }
+
+        uint32_t bucket{FileHashFunction(key) & (header->bucketCount - 1)};
+        uint32_t first{buckets[bucket]};
+        uint32_t last{buckets[bucket + 1]};
+        if (first > last || last > entryCount) {
+            return false;
+        }
+
+        for (uint32_t j{first}; j < last; j++) {
+            if (entries[j].key == key) {
+                if (entries[j].offset > stringLength || entries[j].length > stringLength - entries[j].offset) {
+                    return false;
+                }
+                value = std::string_view(strings + entries[j].offset, entries[j].length);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint64_t size() const {
+        return header ? header->entryCount : 0;
+    }
+
+  private:
+    const char *base;
+    size_t length;
+    const FileHeader *header;
+    const uint32_t *buckets;
+    const FileEntry *entries;
+    uint64_t entryCount;
+    const char *strings;
+    uint64_t stringLength;
+
+    // Every section must lie inside the mapping, in order and aligned for its type. The
+    // counts are compared against the space left rather than multiplied out, so a huge
+    // count cannot wrap around and pass.
+    bool validHeader() const {
+        if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != 1 || header->fileSize != length ||
+            header->bucketCount == 0 || (header->bucketCount & (header->bucketCount - 1)) != 0) {
+            return false;
+        }
+
+        uint64_t bucketBytes{(static_cast<uint64_t>(header->bucketCount) + 1) * sizeof(uint32_t)};
+        if (header->bucketOffset < sizeof(FileHeader) || header->bucketOffset % alignof(uint32_t) != 0 ||
+            header->bucketOffset > length || bucketBytes > length - header->bucketOffset) {
+            return false;
+        }
+
+        if (header->entryOffset < header->bucketOffset + bucketBytes || header->entryOffset % alignof(FileEntry) != 0 ||
+            header->entryOffset > length || header->entryCount > (length - header->entryOffset) / sizeof(FileEntry) ||
+            header->entryCount > UINT32_MAX) {
+            return false;
+        }
+
+        return header->stringOffset >= header->entryOffset + header->entryCount * sizeof(FileEntry) && header->stringOffset <= length;
+    }
+};
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int n{argc > 1 ? std::atoi(argv[1]) : 1000000};
+    std::string path{argc > 2 ? argv[2] : "hash.table"};
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    std::shared_ptr<Hash<int, std::string>> hash{std::make_shared<Hash<int, std::string>>()};
+    for (int j{0}; j < n; j++) {
+        std::shared_ptr<Hash<int, std::string>::Pair> p{std::make_shared<Hash<int, std::string>::Pair>(j, std::to_string(j))};
+        hash->insert(p);
+    }
+    std::cout << "Build Hash (" << n << " entries): " << elapsedSince(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    MappedHashWriter writer;
+    writer.add(*hash);
+    if (!writer.write(path)) {
+        std::cout << "Could not write " << path << std::endl;
+        return 1;
+    }
+    std::cout << "Write " << path << ": " << elapsedSince(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    MappedHash table;
+    if (!table.open(path)) {
+        std::cout << "Could not map " << path << std::endl;
+        return 1;
+    }
+    std::cout << "Open mapped table: " << elapsedSince(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    int found{0};
+    std::string_view value;
+    for (int j{0}; j < n + n / 10; j++) {
+        if (table.search(j, value)) {
+            if (value != std::to_string(j)) {
+                std::cout << "Wrong value for key " << j << std::endl;
+                return 1;
+            }
+            found++;
+        }
+    }
+    std::cout << "Lookups (" << n + n / 10 << ", " << found << " hits): " << elapsedSince(start) << " ms" << std::endl;
+}
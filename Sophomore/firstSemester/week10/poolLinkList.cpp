@@ -0,0 +1,488 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+template <class T>
+class Node {
+  public:
+    Node() : data(std::make_unique<T>()) {}
+
+    Node(T d) : data(std::make_unique<T>(d)) {}
+
+    Node &operator=(T d) {
+        *data = d;
+        return *this;
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, const Node &n) {
+        out << *(n.data);
+        return out;
+    }
+
+    void setData(T d) {
+        *data = d;
+    }
+
+    T &getData() const {
+        return *data;
+    }
+
+  private:
+    std::unique_ptr<T> data;
+};
+
+template <class T>
+class ListNode : public Node<T> {
+  public:
+    ListNode() : Node<T>(), prev(nullptr), next(nullptr) {}
+
+    ListNode(T d) : Node<T>(d), prev(nullptr), next(nullptr) {}
+
+    std::shared_ptr<ListNode<T>> getNext() const {
+        return next;
+    }
+
+    std::shared_ptr<ListNode<T>> getPrev() const {
+        return prev;
+    }
+
+    void setNext(std::shared_ptr<ListNode<T>> n) {
+        next = n;
+    }
+
+    void setPrev(std::shared_ptr<ListNode<T>> p) {
+        prev = p;
+    }
+
+  private:
+    std::shared_ptr<ListNode<T>> prev;
+    std::shared_ptr<ListNode<T>> next;
+};
+
+// The shared_ptr list used by hash.cpp and the graph code, kept here as the benchmark baseline
+template <class T>
+class LinkList {
+  public:
+    LinkList() : head(nullptr), tail(nullptr) {}
+
+    void addFromTail(T d) {
+        std::shared_ptr<ListNode<T>> node{std::make_shared<ListNode<T>>(d)};
+        if (tail != nullptr) {
+            tail->setNext(node);
+        }
+
+        node->setPrev(tail);
+        tail = node;
+        if (head == nullptr) {
+            head = tail;
+        }
+    }
+
+    std::shared_ptr<ListNode<T>> removeFromHead() {
+        std::shared_ptr<ListNode<T>> node{head};
+        if (head != nullptr) {
+            head = head->getNext();
+            if (head != nullptr)
+                head->setPrev(nullptr);
+            else
+                tail = nullptr;
+            node->setNext(nullptr);
+        }
+        return node;
+    }
+
+    std::shared_ptr<ListNode<T>> removeFromTail() {
+        std::shared_ptr<ListNode<T>> node{tail};
+        if (tail != nullptr) {
+            tail = tail->getPrev();
+
+            if (tail != nullptr)
+                tail->setNext(nullptr);
+            else
+                head = nullptr;
+            node->setPrev(nullptr);
+        }
+        return node;
+    }
+
+    std::shared_ptr<ListNode<T>> remove(std::shared_ptr<ListNode<T>> node) {
+        if (!exist(node)) {
+            return nullptr;
+        }
+
+        if (node == head) {
+            return removeFromHead();
+        } else if (node == tail) {
+            return removeFromTail();
+        } else {
+            node->getPrev()->setNext(node->getNext());
+            node->getNext()->setPrev(node->getPrev());
+            node->setPrev(nullptr);
+            node->setNext(nullptr);
+            return node;
+        }
+    }
+
+    bool exist(std::shared_ptr<ListNode<T>> node) {
+        for (std::shared_ptr<ListNode<T>> j{head}; j != nullptr; j = j->getNext()) {
+            if (j == node) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::shared_ptr<ListNode<T>> head;
+    std::shared_ptr<ListNode<T>> tail;
+};
+
+// Doubly linked list whose nodes live inline in slabs of SLAB_SIZE slots.
+// Links are 32-bit slot indices, so growing the pool never moves a node, and
+// freed slots are recycled through a free list threaded through `next`.
+// A Handle carries the slot generation, which makes exist() and remove() O(1).
+template <class T>
+class PoolLinkList {
+  public:
+    static constexpr uint32_t NIL{UINT32_MAX};
+
+    struct Handle {
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    class Iterator {
+      public:
+        Iterator(const PoolLinkList *l, uint32_t i) : list(l), index(i) {}
+
+        T &operator*() const {
+            return list->slot(index).data();
+        }
+
+        T *operator->() const {
+            return &list->slot(index).data();
+        }
+
+        Iterator &operator++() {
+            index = list->slot(index).next;
+            return *this;
+        }
+
+        Iterator &operator--() {
+            index = (index == NIL) ? list->tail : list->slot(index).prev;
+            return *this;
+        }
+
+        bool operator==(const Iterator &other) const {
+            return index == other.index;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return index != other.index;
+        }
+
+        Handle handle() const {
+            return {index, list->slot(index).generation};
+        }
+
+      private:
+        const PoolLinkList *list;
+        uint32_t index;
+    };
+
+    PoolLinkList() : head(NIL), tail(NIL), count(0), used(0), freeHead(NIL) {}
+
+    PoolLinkList(const PoolLinkList &) = delete;
+    PoolLinkList &operator=(const PoolLinkList &) = delete;
+
+    ~PoolLinkList() {
+        clear();
+    }
+
+    Handle addFromHead(const T &d) {
+        uint32_t node{allocate(d)};
+        link(node, NIL, head);
+        return {node, slot(node).generation};
+    }
+
+    Handle addFromTail(const T &d) {
+        uint32_t node{allocate(d)};
+        link(node, tail, NIL);
+        return {node, slot(node).generation};
+    }
+
+    Handle addAfter(Handle node, const T &d) {
+        if (!exist(node)) {
+            return {NIL, 0};
+        }
+
+        uint32_t newNode{allocate(d)};
+        link(newNode, node.index, slot(node.index).next);
+        return {newNode, slot(newNode).generation};
+    }
+
+    bool removeFromHead(T &value) {
+        if (head == NIL) {
+            return false;
+        }
+        value = slot(head).data();
+        release(unlink(head));
+        return true;
+    }
+
+    bool removeFromTail(T &value) {
+        if (tail == NIL) {
+            return false;
+        }
+        value = slot(tail).data();
+        release(unlink(tail));
+        return true;
+    }
+
+    bool remove(Handle node) {
+        if (!exist(node)) {
+            return false;
+        }
+        release(unlink(node.index));
+        return true;
+    }
+
+    bool exist(Handle node) const {
+        return node.index < used && slot(node.index).generation == node.generation && (node.generation & 1);
+    }
+
+    Handle exist(const T &d) const {
+        for (uint32_t j{head}; j != NIL; j = slot(j).next) {
+            if (slot(j).data() == d) {
+                return {j, slot(j).generation};
+            }
+        }
+        return {NIL, 0};
+    }
+
+    T &getData(Handle node) const {
+        return slot(node.index).data();
+    }
+
+    T &operator[](int n) const {
+        uint32_t j{head};
+        for (int i{0}; i < n && j != NIL; i++) {
+            j = slot(j).next;
+        }
+
+        if (n < 0 || j == NIL) {
+            throw std::out_of_range("Index out of range");
+        }
+        return slot(j).data();
+    }
+
+    Iterator begin() const {
+        return Iterator(this, head);
+    }
+
+    Iterator end() const {
+        return Iterator(this, NIL);
+    }
+
+    int size() const {
+        return count;
+    }
+
+    void clear() {
+        while (head != NIL) {
+            release(unlink(head));
+        }
+    }
+
+    void print() const {
+        for (const T &d : *this) {
+            std::cout << d << " ";
+        }
+        std::cout << std::endl;
+    }
+
+  private:
+    static constexpr uint32_t SLAB_BITS{10};
+    static constexpr uint32_t SLAB_SIZE{1u << SLAB_BITS};
+
+    // generation is odd while the slot holds a live node
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+        uint32_t prev;
+        uint32_t next;
+        uint32_t generation;
+
+        T &data() {
+            return *std::launder(reinterpret_cast<T *>(storage));
+        }
+    };
+
+    uint32_t head;
+    uint32_t tail;
+    int count;
+    uint32_t used;
+    uint32_t freeHead;
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+
+    Slot &slot(uint32_t index) const {
+        return slabs[index >> SLAB_BITS][index & (SLAB_SIZE - 1)];
+    }
+
+    uint32_t allocate(const T &d) {
+        uint32_t index{freeHead};
+        if (index != NIL) {
+            freeHead = slot(index).next;
+        } else {
+            if (used == slabs.size() * SLAB_SIZE) {
+                slabs.push_back(std::make_unique<Slot[]>(SLAB_SIZE));
+            }
+            index = used++;
+            slot(index).generation = 0;
+        }
+
+        Slot &s{slot(index)};
+        new (s.storage) T(d);
+        s.generation++;
+        count++;
+        return index;
+    }
+
+    void release(uint32_t index) {
+        Slot &s{slot(index)};
+        s.data().~T();
+        s.generation++;
+        s.next = freeHead;
+        freeHead = index;
+        count--;
+    }
+
+    void link(uint32_t node, uint32_t prev, uint32_t next) {
+        slot(node).prev = prev;
+        slot(node).next = next;
+        (prev == NIL ? head : slot(prev).next) = node;
+        (next == NIL ? tail : slot(next).prev) = node;
+    }
+
+    uint32_t unlink(uint32_t node) {
+        uint32_t prev{slot(node).prev};
+        uint32_t next{slot(node).next};
+        (prev == NIL ? head : slot(prev).next) = next;
+        (next == NIL ? tail : slot(next).prev) = prev;
+        return node;
+    }
+};
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void benchmark(int n, int removals) {
+    std::cout << "n = " << n << std::endl;
+    // at least 1, so lists shorter than removals do not divide by zero
+    int stride{std::max(1, n / removals)};
+
+    // shared_ptr LinkList
+    {
+        LinkList<int> list;
+        std::vector<std::shared_ptr<ListNode<int>>> nodes;
+
+        std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+        for (int j{0}; j < n; j++) {
+            list.addFromTail(j);
+        }
+        double insert{elapsedSince(start)};
+
+        start = std::chrono::steady_clock::now();
+        long long sum{0};
+        for (std::shared_ptr<ListNode<int>> j{list.head}; j != nullptr; j = j->getNext()) {
+            sum += j->getData();
+        }
+        double traverse{elapsedSince(start)};
+
+        // every stride-th node, so exist() has to walk deep into the list
+        int i{0};
+        for (std::shared_ptr<ListNode<int>> j{list.head}; j != nullptr; j = j->getNext(), i++) {
+            if (i % stride == 0) {
+                nodes.push_back(j);
+            }
+        }
+
+        start = std::chrono::steady_clock::now();
+        for (int j{static_cast<int>(nodes.size()) - 1}; j >= 0; j--) {
+            list.remove(nodes[j]);
+        }
+        double removeHandle{elapsedSince(start)};
+
+        start = std::chrono::steady_clock::now();
+        while (list.removeFromHead() != nullptr) {
+        }
+        double removeHead{elapsedSince(start)};
+
+        std::cout << "  LinkList     insert " << insert << " ms, traverse " << traverse << " ms (sum " << sum << "), remove(node) x" << nodes.size()
+                  << " " << removeHandle << " ms, removeFromHead " << removeHead << " ms" << std::endl;
+    }
+
+    // pool-allocated PoolLinkList
+    {
+        PoolLinkList<int> list;
+        std::vector<PoolLinkList<int>::Handle> nodes;
+
+        std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+        for (int j{0}; j < n; j++) {
+            list.addFromTail(j);
+        }
+        double insert{elapsedSince(start)};
+
+        start = std::chrono::steady_clock::now();
+        long long sum{0};
+        for (int d : list) {
+            sum += d;
+        }
+        double traverse{elapsedSince(start)};
+
+        int i{0};
+        for (PoolLinkList<int>::Iterator j{list.begin()}; j != list.end(); ++j, i++) {
+            if (i % stride == 0) {
+                nodes.push_back(j.handle());
+            }
+        }
+
+        start = std::chrono::steady_clock::now();
+        for (int j{static_cast<int>(nodes.size()) - 1}; j >= 0; j--) {
+            list.remove(nodes[j]);
+        }
+        double removeHandle{elapsedSince(start)};
+
+        start = std::chrono::steady_clock::now();
+        int value;
+        while (list.removeFromHead(value)) {
+        }
+        double removeHead{elapsedSince(start)};
+
+        std::cout << "  PoolLinkList insert " << insert << " ms, traverse " << traverse << " ms (sum " << sum << "), remove(node) x" << nodes.size()
+                  << " " << removeHandle << " ms, removeFromHead " << removeHead << " ms" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    PoolLinkList<int> list;
+    PoolLinkList<int>::Handle two{list.addFromTail(2)};
+    list.addFromHead(1);
+    PoolLinkList<int>::Handle four{list.addFromTail(4)};
+    list.addAfter(two, 3);
+    list.print();
+
+    list.remove(four);
+    std::cout << "Removed 4, handle still valid: " << (list.exist(four) ? "yes" : "no") << std::endl;
+    list.addFromTail(5);
+    std::cout << "Slot reused by 5, old handle valid: " << (list.exist(four) ? "yes" : "no") << std::endl;
+    list.print();
+
+    int n{argc > 1 ? std::atoi(argv[1]) : 1000000};
+    benchmark(n, 200);
+}
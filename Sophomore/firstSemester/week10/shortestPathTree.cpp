@@ -1,7 +1,14 @@
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <string>
+#include <vector>
 
 template <class T>
 class Node {
@@ -201,15 +208,109 @@ class LinkList {
     std::shared_ptr<ListNode<T>> tail;
 };
 
+// 4-ary min-heap over dense ids 0..n-1 with decrease-key; pos[id] is the slot of id or -1
+template <class K>
+class IndexedHeap {
+  public:
+    IndexedHeap(int n) : pos(n, -1), key(n) {}
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    bool contains(int id) const {
+        return pos[id] >= 0;
+    }
+
+    void push(int id, K k) {
+        key[id] = k;
+        pos[id] = heap.size();
+        heap.push_back(id);
+        siftUp(pos[id]);
+    }
+
+    void decreaseKey(int id, K k) {
+        key[id] = k;
+        siftUp(pos[id]);
+    }
+
+    int pop() {
+        int top{heap[0]};
+        pos[top] = -1;
+
+        int last{heap.back()};
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            pos[last] = 0;
+            siftDown(0);
+        }
+        return top;
+    }
+
+  private:
+    static constexpr int D{4};
+
+    std::vector<int> heap;
+    std::vector<int> pos;
+    std::vector<K> key;
+
+    void siftUp(int i) {
+        int id{heap[i]};
+        while (i > 0) {
+            int parent{(i - 1) / D};
+            if (key[heap[parent]] <= key[id]) {
+                break;
+            }
+            heap[i] = heap[parent];
+            pos[heap[i]] = i;
+            i = parent;
+        }
+        heap[i] = id;
+        pos[id] = i;
+    }
+
+    void siftDown(int i) {
+        int id{heap[i]};
+        int n{static_cast<int>(heap.size())};
+        while (true) {
+            int first{i * D + 1};
+            if (first >= n) {
+                break;
+            }
+
+            int best{first};
+            for (int c{first + 1}; c < first + D && c < n; c++) {
+                if (key[heap[c]] < key[heap[best]]) {
+                    best = c;
+                }
+            }
+
+            if (key[heap[best]] >= key[id]) {
+                break;
+            }
+            heap[i] = heap[best];
+            pos[heap[i]] = i;
+            i = best;
+        }
+        heap[i] = id;
+        pos[id] = i;
+    }
+};
+
 template <class V, class E>
 class WeightedGraphEdge;
 
 template <class V, class E>
 class WeightedGraphVertex : public Node<V> {
   public:
-    WeightedGraphVertex() : Node<V>(), list(std::make_shared<LinkList<WeightedGraphEdge<V, E> *>>()) {}
+    WeightedGraphVertex() : Node<V>(), id(0), list(std::make_shared<LinkList<WeightedGraphEdge<V, E> *>>()) {}
 
-    WeightedGraphVertex(V d) : Node<V>(d), list(std::make_shared<LinkList<WeightedGraphEdge<V, E> *>>()) {}
+    WeightedGraphVertex(V d, int i = 0) : Node<V>(d), id(i), list(std::make_shared<LinkList<WeightedGraphEdge<V, E> *>>()) {}
+
+    int getId() const {
+        return id;
+    }
 
     void addEdge(std::shared_ptr<WeightedGraphEdge<V, E>> edge) {
         list->addFromTail(edge.get());
@@ -230,6 +331,7 @@ class WeightedGraphVertex : public Node<V> {
     }
 
   private:
+    int id;
     std::shared_ptr<LinkList<WeightedGraphEdge<V, E> *>> list;
 };
 
@@ -281,10 +383,11 @@ class WeightedGraph {
         }
 
         this->edge->addFromTail(edge);
+        edgeCount++;
     }
 
     std::shared_ptr<WeightedGraphVertex<V, E>> addVertex(V d) {
-        std::shared_ptr<WeightedGraphVertex<V, E>> v{std::make_shared<WeightedGraphVertex<V, E>>(d)};
+        std::shared_ptr<WeightedGraphVertex<V, E>> v{std::make_shared<WeightedGraphVertex<V, E>>(d, vertexCount)};
 
         vertex->addFromTail(v);
         vertexCount++;
@@ -300,7 +403,7 @@ class WeightedGraph {
             std::shared_ptr<ListNode<WeightedGraphEdge<V, E> *>> e = (*temp)[0];
 
             while (e != nullptr) {
-                std::cout << e->getData()->getAnotherEnd(temp) << "(" << e->getData()->getData() << ") ";
+                std::cout << *e->getData()->getAnotherEnd(temp) << "(" << e->getData()->getData() << ") ";
                 e = e->getNext();
             }
 
@@ -310,7 +413,76 @@ class WeightedGraph {
     }
 
     std::shared_ptr<WeightedGraph> shortestPathTree(std::shared_ptr<WeightedGraphVertex<V, E>> start) {
-        return nullptr;
+        std::vector<E> dist;
+        std::vector<int> parent;
+        return shortestPathTree(start, dist, parent);
+    }
+
+    // Dijkstra with an indexed 4-ary heap, O((V + E) log V). dist and parent are indexed by
+    // vertex id (order of addVertex); unreachable vertices keep numeric_limits<E>::max() and -1.
+    // The tree holds a copy of every reachable vertex linked to its parent by the original weight.
+    std::shared_ptr<WeightedGraph> shortestPathTree(std::shared_ptr<WeightedGraphVertex<V, E>> start, std::vector<E> &dist, std::vector<int> &parent) {
+        std::vector<std::shared_ptr<WeightedGraphVertex<V, E>>> vertices;
+        std::vector<int> offset(vertexCount + 1, 0);
+        std::vector<int> target;
+        std::vector<E> weight;
+        target.reserve(2 * edgeCount);
+        weight.reserve(2 * edgeCount);
+
+        // Flatten the adjacency lists once so the search never touches shared_ptr links
+        for (std::shared_ptr<ListNode<std::shared_ptr<WeightedGraphVertex<V, E>>>> cur{vertex->head}; cur != nullptr; cur = cur->getNext()) {
+            std::shared_ptr<WeightedGraphVertex<V, E>> v{cur->getData()};
+            vertices.push_back(v);
+            for (std::shared_ptr<ListNode<WeightedGraphEdge<V, E> *>> e{(*v)[0]}; e != nullptr; e = e->getNext()) {
+                target.push_back(e->getData()->getAnotherEnd(v)->getId());
+                weight.push_back(e->getData()->getData());
+            }
+            offset[v->getId() + 1] = target.size();
+        }
+
+        dist.assign(vertexCount, std::numeric_limits<E>::max());
+        parent.assign(vertexCount, -1);
+        std::vector<E> parentWeight(vertexCount);
+        std::vector<bool> done(vertexCount, false);
+        IndexedHeap<E> heap(vertexCount);
+
+        dist[start->getId()] = 0;
+        heap.push(start->getId(), 0);
+        while (!heap.empty()) {
+            int u{heap.pop()};
+            done[u] = true;
+
+            for (int a{offset[u]}; a < offset[u + 1]; a++) {
+                int v{target[a]};
+                if (done[v] || dist[u] + weight[a] >= dist[v]) {
+                    continue;
+                }
+
+                dist[v] = dist[u] + weight[a];
+                parent[v] = u;
+                parentWeight[v] = weight[a];
+                if (heap.contains(v)) {
+                    heap.decreaseKey(v, dist[v]);
+                } else {
+                    heap.push(v, dist[v]);
+                }
+            }
+        }
+
+        std::shared_ptr<WeightedGraph> tree{std::make_shared<WeightedGraph>()};
+        std::vector<std::shared_ptr<WeightedGraphVertex<V, E>>> copy(vertexCount);
+        for (int v{0}; v < vertexCount; v++) {
+            if (done[v]) {
+                copy[v] = tree->addVertex(vertices[v]->getData());
+            }
+        }
+        for (int v{0}; v < vertexCount; v++) {
+            if (parent[v] != -1) {
+                tree->addLink(copy[parent[v]], copy[v], parentWeight[v]);
+            }
+        }
+
+        return tree;
     }
 
   private:
@@ -320,7 +492,92 @@ class WeightedGraph {
     std::shared_ptr<LinkList<std::shared_ptr<WeightedGraphEdge<V, E>>>> edge;
 };
 
-int main(void) {
+// Edge file written by week10/graphIO.cpp: a 48-byte header, then packed (u, v, w) triples
+struct EdgeFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t vertexCount;
+    uint64_t edgeCount;
+    uint64_t edgeOffset;
+    uint64_t fileSize;
+};
+
+struct FileEdge {
+    uint32_t u;
+    uint32_t v;
+    int32_t w;
+};
+
+// The edge count is checked against the file length before anything is allocated for it
+bool readEdgeFile(const std::string &path, uint32_t &n, std::vector<FileEdge> &edges) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    std::streamoff length{in.tellg()};
+    EdgeFileHeader header;
+    if (length < static_cast<std::streamoff>(sizeof(header)) || !in.seekg(0) || !in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "NDHUEDG1", 8) != 0 || header.version != 1 || header.vertexCount == 0 || header.vertexCount > INT32_MAX ||
+        header.edgeOffset < sizeof(header) || header.edgeOffset > static_cast<uint64_t>(length) ||
+        header.edgeCount > (static_cast<uint64_t>(length) - header.edgeOffset) / sizeof(FileEdge)) {
+        return false;
+    }
+
+    n = static_cast<uint32_t>(header.vertexCount);
+    edges.resize(header.edgeCount);
+    in.seekg(header.edgeOffset);
+    if (!in.read(reinterpret_cast<char *>(edges.data()), edges.size() * sizeof(FileEdge))) {
+        return false;
+    }
+    for (const FileEdge &e : edges) {
+        if (e.u >= n || e.v >= n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// "run <edges file> dijkstra": times the shortest path tree from vertex 0 and prints
+// algorithm,ms,checksum for week10/graphBenchmark.cpp; the checksum is the sum of the
+// finite distances
+int runFile(const std::string &path, const std::string &algorithm) {
+    uint32_t n;
+    std::vector<FileEdge> edges;
+    if (!readEdgeFile(path, n, edges)) {
+        std::cerr << "Could not read " << path << std::endl;
+        return 1;
+    }
+    if (algorithm != "dijkstra") {
+        std::cerr << "Unknown algorithm " << algorithm << std::endl;
+        return 2;
+    }
+
+    std::shared_ptr<WeightedGraph<int, int>> g{std::make_shared<WeightedGraph<int, int>>()};
+    std::vector<std::shared_ptr<WeightedGraphVertex<int, int>>> vertices;
+    for (int j{0}; j < static_cast<int>(n); j++) {
+        vertices.push_back(g->addVertex(j));
+    }
+    for (const FileEdge &e : edges) {
+        g->addLink(vertices[e.u], vertices[e.v], e.w);
+    }
+
+    std::vector<int> dist;
+    std::vector<int> parent;
+    long long checksum{0};
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    g->shortestPathTree(vertices[0], dist, parent);
+    for (int d : dist) {
+        checksum += d == std::numeric_limits<int>::max() ? 0 : d;
+    }
+    std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() - start};
+
+    std::cout << algorithm << "," << elapsed.count() << "," << checksum << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 3 && std::string(argv[1]) == "run") {
+        return runFile(argv[2], argv[3]);
+    }
+
     std::shared_ptr<WeightedGraph<char, int>> g{std::make_shared<WeightedGraph<char, int>>()};
     std::shared_ptr<WeightedGraph<char, int>> tree;
 
@@ -342,8 +599,34 @@ int main(void) {
     tree = g->shortestPathTree((*g)[0]);
 
     if (tree) {
+        std::cout << "Shortest path tree from " << *(*g)[0] << ":" << std::endl;
         tree->adjList();
     } else {
         std::cout << "The shortest path tree could not be computed." << std::endl;
     }
+
+    // Scale test on a random graph with 200000 vertices and 1000000 edges
+    const int n{200000};
+    const int m{1000000};
+    std::shared_ptr<WeightedGraph<int, int>> big{std::make_shared<WeightedGraph<int, int>>()};
+    std::vector<std::shared_ptr<WeightedGraphVertex<int, int>>> vertices;
+
+    for (int j{0}; j < n; j++) {
+        vertices.push_back(big->addVertex(j));
+    }
+    for (int j{0}; j < m; j++) {
+        big->addLink(vertices[rand() % n], vertices[rand() % n], rand() % 100 + 1);
+    }
+
+    std::vector<int> dist;
+    std::vector<int> parent;
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    big->shortestPathTree(vertices[0], dist, parent);
+    std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() - start};
+
+    int reached{0};
+    for (int d : dist) {
+        reached += (d != std::numeric_limits<int>::max());
+    }
+    std::cout << "Shortest path tree on " << n << " vertices / " << m << " edges: " << elapsed.count() << " ms, " << reached << " reached" << std::endl;
 }
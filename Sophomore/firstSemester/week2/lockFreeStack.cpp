@@ -0,0 +1,178 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#define CACHE_LINE 64
+
+// Bounded Treiber stack. Nodes come from a fixed pool and are addressed by 32-bit
+// index; the top of the stack and the free list pack that index with a 32-bit tag
+// that is bumped on every successful CAS, so a node popped and pushed back between
+// another thread's load and CAS (the ABA case) makes that CAS fail.
+template <class T>
+class LockFreeStack {
+  public:
+    explicit LockFreeStack(uint32_t capacity) : size(capacity), nodes(new Node[capacity]) {
+        for (uint32_t j{0}; j < size; j++) {
+            nodes[j].next.store(j + 1 < size ? j + 1 : NIL, std::memory_order_relaxed);
+        }
+        top.store(pack(NIL, 0), std::memory_order_relaxed);
+        freeList.store(pack(size > 0 ? 0 : NIL, 0), std::memory_order_relaxed);
+    }
+
+    LockFreeStack(const LockFreeStack &) = delete;
+    LockFreeStack &operator=(const LockFreeStack &) = delete;
+
+    ~LockFreeStack() {
+        delete[] nodes;
+    }
+
+    // Non-blocking, returns false when the stack is full
+    bool push(const T &value) {
+        uint32_t node{popIndex(freeList)};
+        if (node == NIL) {
+            return false;
+        }
+
+        nodes[node].data = value;
+        pushIndex(top, node);
+        return true;
+    }
+
+    // Non-blocking, returns false when the stack is empty
+    bool pop(T &value) {
+        uint32_t node{popIndex(top)};
+        if (node == NIL) {
+            return false;
+        }
+
+        value = nodes[node].data;
+        pushIndex(freeList, node);
+        return true;
+    }
+
+    void blockingPush(const T &value) {
+        for (int spin{0}; !push(value); spin++) {
+            if (spin > 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void blockingPop(T &value) {
+        for (int spin{0}; !pop(value); spin++) {
+            if (spin > 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+  private:
+    static constexpr uint32_t NIL{UINT32_MAX};
+
+    struct Node {
+        std::atomic<uint32_t> next;
+        T data;
+    };
+
+    uint32_t size;
+    Node *nodes;
+    alignas(CACHE_LINE) std::atomic<uint64_t> top;
+    alignas(CACHE_LINE) std::atomic<uint64_t> freeList;
+
+    static uint64_t pack(uint32_t index, uint32_t tag) {
+        return (static_cast<uint64_t>(tag) << 32) | index;
+    }
+
+    static uint32_t indexOf(uint64_t word) {
+        return static_cast<uint32_t>(word);
+    }
+
+    static uint32_t tagOf(uint64_t word) {
+        return static_cast<uint32_t>(word >> 32);
+    }
+
+    void pushIndex(std::atomic<uint64_t> &list, uint32_t node) {
+        uint64_t old{list.load(std::memory_order_relaxed)};
+        do {
+            nodes[node].next.store(indexOf(old), std::memory_order_relaxed);
+        } while (!list.compare_exchange_weak(old, pack(node, tagOf(old) + 1), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    uint32_t popIndex(std::atomic<uint64_t> &list) {
+        uint64_t old{list.load(std::memory_order_acquire)};
+        while (indexOf(old) != NIL) {
+            uint32_t next{nodes[indexOf(old)].next.load(std::memory_order_relaxed)};
+            if (list.compare_exchange_weak(old, pack(next, tagOf(old) + 1), std::memory_order_acquire, std::memory_order_acquire)) {
+                return indexOf(old);
+            }
+        }
+        return NIL;
+    }
+};
+
+// Every producer pushes 1..items, consumers pop until all items are seen
+void benchmark(int producers, int consumers, long long items) {
+    LockFreeStack<long long> stack(1024);
+    std::atomic<long long> consumed{0};
+    std::atomic<long long> sum{0};
+    long long total{items * producers};
+    std::vector<std::thread> threads;
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    for (int p{0}; p < producers; p++) {
+        threads.emplace_back([&]() {
+            for (long long j{1}; j <= items; j++) {
+                stack.blockingPush(j);
+            }
+        });
+    }
+
+    for (int c{0}; c < consumers; c++) {
+        threads.emplace_back([&]() {
+            long long local{0};
+            long long value;
+            while (consumed.load(std::memory_order_relaxed) < total) {
+                if (stack.pop(value)) {
+                    local += value;
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            sum += local;
+        });
+    }
+
+    for (std::thread &t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+    bool correct{sum.load() == producers * (items * (items + 1) / 2)};
+    std::cout << producers << "," << consumers << "," << static_cast<long long>(total / elapsed.count()) << "," << (correct ? "ok" : "MISMATCH") << std::endl;
+}
+
+int main(void) {
+    LockFreeStack<int> stack(3);
+    int data{0};
+
+    for (int j{1}; j <= 5; j++) {
+        if (stack.push(j)) {
+            std::cout << "Successfully pushed " << j << " into the stack." << std::endl;
+        } else {
+            std::cout << "Stack is full. Failed to push " << j << "." << std::endl;
+        }
+    }
+
+    while (stack.pop(data)) {
+        std::cout << "Popped " << data << " from the stack." << std::endl;
+    }
+
+    std::cout << "producers,consumers,items_per_sec,check" << std::endl;
+    benchmark(1, 1, 1000000);
+    benchmark(2, 2, 500000);
+    benchmark(4, 4, 250000);
+}
@@ -0,0 +1,179 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#define CACHE_LINE 64
+
+// Bounded multi-producer multi-consumer ring buffer (Vyukov). Every cell carries a
+// sequence number: a producer may fill the cell of position pos when sequence == 2 pos,
+// a consumer may drain it when sequence == 2 pos + 1, so head and tail never need a
+// shared lock. Doubling keeps "full at pos" and "empty for pos + size" apart even when
+// size is 1.
+// The ring holds exactly the requested capacity (at least 1). Power-of-two sizes map a
+// position to its cell with a mask, any other size with a modulo.
+template <class T>
+class MPMCQueue {
+  public:
+    explicit MPMCQueue(size_t capacity) : size(capacity > 0 ? capacity : 1), mask((size & (size - 1)) == 0 ? size - 1 : 0) {
+        buffer = new Cell[size];
+        for (size_t j{0}; j < size; j++) {
+            buffer[j].sequence.store(2 * j, std::memory_order_relaxed);
+        }
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    MPMCQueue(const MPMCQueue &) = delete;
+    MPMCQueue &operator=(const MPMCQueue &) = delete;
+
+    ~MPMCQueue() {
+        delete[] buffer;
+    }
+
+    // Non-blocking, returns false when the queue is full
+    bool enqueue(const T &value) {
+        size_t pos{head.load(std::memory_order_relaxed)};
+        while (true) {
+            Cell &cell{buffer[index(pos)]};
+            size_t sequence{cell.sequence.load(std::memory_order_acquire)};
+            std::ptrdiff_t diff{static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(2 * pos)};
+
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.data = value;
+                    cell.sequence.store(2 * pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Non-blocking, returns false when the queue is empty
+    bool dequeue(T &value) {
+        size_t pos{tail.load(std::memory_order_relaxed)};
+        while (true) {
+            Cell &cell{buffer[index(pos)]};
+            size_t sequence{cell.sequence.load(std::memory_order_acquire)};
+            std::ptrdiff_t diff{static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(2 * pos + 1)};
+
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.data;
+                    cell.sequence.store(2 * (pos + size), std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void blockingEnqueue(const T &value) {
+        for (int spin{0}; !enqueue(value); spin++) {
+            if (spin > 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void blockingDequeue(T &value) {
+        for (int spin{0}; !dequeue(value); spin++) {
+            if (spin > 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    size_t capacity() const {
+        return size;
+    }
+
+  private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    size_t size;
+    size_t mask; // size - 1 for power-of-two sizes, otherwise 0
+    Cell *buffer;
+
+    size_t index(size_t pos) const {
+        return mask != 0 ? pos & mask : pos % size;
+    }
+    alignas(CACHE_LINE) std::atomic<size_t> head;
+    alignas(CACHE_LINE) std::atomic<size_t> tail;
+};
+
+// Every producer pushes 1..items, consumers share the stream until all items are seen
+void benchmark(int producers, int consumers, long long items) {
+    MPMCQueue<long long> queue(1024);
+    std::atomic<long long> consumed{0};
+    std::atomic<long long> sum{0};
+    long long total{items * producers};
+    std::vector<std::thread> threads;
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    for (int p{0}; p < producers; p++) {
+        threads.emplace_back([&]() {
+            for (long long j{1}; j <= items; j++) {
+                queue.blockingEnqueue(j);
+            }
+        });
+    }
+
+    for (int c{0}; c < consumers; c++) {
+        threads.emplace_back([&]() {
+            long long local{0};
+            long long value;
+            while (consumed.load(std::memory_order_relaxed) < total) {
+                if (queue.dequeue(value)) {
+                    local += value;
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            sum += local;
+        });
+    }
+
+    for (std::thread &t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+    bool correct{sum.load() == producers * (items * (items + 1) / 2)};
+    std::cout << producers << "," << consumers << "," << static_cast<long long>(total / elapsed.count()) << "," << (correct ? "ok" : "MISMATCH") << std::endl;
+}
+
+int main(void) {
+    MPMCQueue<int> queue(3);
+    int data{0};
+
+    for (int j{1}; j <= 5; j++) {
+        if (queue.enqueue(j)) {
+            std::cout << "Successfully enqueued " << j << " into the queue." << std::endl;
+        } else {
+            std::cout << "Queue is full. Failed to enqueue " << j << "." << std::endl;
+        }
+    }
+
+    while (queue.dequeue(data)) {
+        std::cout << "Dequeued " << data << " from the queue." << std::endl;
+    }
+
+    std::cout << "producers,consumers,items_per_sec,check" << std::endl;
+    benchmark(1, 1, 1000000);
+    benchmark(2, 2, 500000);
+    benchmark(4, 4, 250000);
+}
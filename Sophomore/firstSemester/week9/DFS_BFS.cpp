@@ -1,10 +1,18 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <ctime>
+#include <fstream>
 #include <iostream>
 #include <memory>
-#include <queue>
-#include <stack>
+#include <random>
 #include <stdexcept>
-#include <unordered_set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 template <class T>
 class Node {
@@ -109,6 +117,13 @@ class LinkList {
         return *current;
     }
 
+    template <class F>
+    void forEach(F f) const {
+        for (std::shared_ptr<ListNode<T>> current{head}; current != nullptr; current = current->getNext()) {
+            f(current->getData());
+        }
+    }
+
     void print() const {
         std::shared_ptr<ListNode<T>> current{head};
         while (current != nullptr) {
@@ -122,25 +137,172 @@ class LinkList {
     std::shared_ptr<ListNode<T>> head, tail;
 };
 
+// Fixed-size bit set whose words can be updated from several threads at once
+class AtomicBitmap {
+  public:
+    explicit AtomicBitmap(int n) : words((n + 63) / 64), bits(new std::atomic<uint64_t>[words]) {
+        clear();
+    }
+
+    void clear() {
+        for (int j{0}; j < words; j++) {
+            bits[j].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool test(int i) const {
+        return (bits[i >> 6].load(std::memory_order_relaxed) >> (i & 63)) & 1;
+    }
+
+    void set(int i) {
+        bits[i >> 6].fetch_or(uint64_t{1} << (i & 63), std::memory_order_relaxed);
+    }
+
+    // Returns true only for the one caller that flipped the bit from 0 to 1
+    bool testAndSet(int i) {
+        uint64_t mask{uint64_t{1} << (i & 63)};
+        if (bits[i >> 6].load(std::memory_order_relaxed) & mask) {
+            return false;
+        }
+        return (bits[i >> 6].fetch_or(mask, std::memory_order_relaxed) & mask) == 0;
+    }
+
+    void swap(AtomicBitmap &other) {
+        std::swap(words, other.words);
+        std::swap(bits, other.bits);
+    }
+
+  private:
+    int words;
+    std::unique_ptr<std::atomic<uint64_t>[]> bits;
+};
+
+// Runs f(t, lo, hi) on `threads` contiguous slices of [0, n), inline when threads is 1
+template <class F>
+void parallelFor(int n, int threads, F f) {
+    if (threads <= 1) {
+        f(0, 0, n);
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    int chunk{(n + threads - 1) / threads};
+    for (int t{0}, lo{0}; lo < n; t++, lo += chunk) {
+        pool.emplace_back(f, t, lo, std::min(n, lo + chunk));
+    }
+    for (std::thread &t : pool) {
+        t.join();
+    }
+}
+
+// Iterative depth-first search over a flattened adjacency (the neighbours of u are
+// target[offset[u] .. offset[u + 1])). Each vertex on the current path owns one
+// (vertex, next arc) frame, so nothing is pushed twice and long paths cannot overflow
+// the call stack. The frame stack and visited stamps are kept between traversals.
+class DFSEngine {
+  public:
+    DFSEngine() : stamp(0) {}
+
+    // Starts a new search over n vertices with nothing visited; several run() calls
+    // after one reset() share the visited set
+    void reset(int n) {
+        if (static_cast<int>(seen.size()) < n) {
+            seen.resize(n, 0);
+        }
+        if (++stamp == 0) {
+            std::fill(seen.begin(), seen.end(), 0);
+            stamp = 1;
+        }
+        stack.reserve(n);
+    }
+
+    bool visited(int u) const {
+        return seen[u] == stamp;
+    }
+
+    // onEnter(u, parent) fires in preorder (parent is -1 for the source), onRevisit(u, v)
+    // for every arc u -> v whose end was already discovered, onExit(u) in postorder.
+    // Arcs are tried from the back of each list. A false return from onEnter or onRevisit
+    // stops the search and makes run() return false.
+    template <class Enter, class Revisit, class Exit>
+    bool run(int source, const std::vector<int> &offset, const std::vector<int> &target, Enter onEnter, Revisit onRevisit, Exit onExit) {
+        if (visited(source)) {
+            return true;
+        }
+
+        stack.clear();
+        seen[source] = stamp;
+        if (!onEnter(source, -1)) {
+            return false;
+        }
+        stack.push_back({source, offset[source + 1]});
+
+        while (!stack.empty()) {
+            Frame &top{stack.back()};
+            int u{top.vertex};
+            if (top.arc == offset[u]) {
+                stack.pop_back();
+                onExit(u);
+                continue;
+            }
+
+            int v{target[--top.arc]};
+            if (seen[v] == stamp) {
+                if (!onRevisit(u, v)) {
+                    return false;
+                }
+                continue;
+            }
+
+            seen[v] = stamp;
+            if (!onEnter(v, u)) {
+                return false;
+            }
+            stack.push_back({v, offset[v + 1]});
+        }
+        return true;
+    }
+
+  private:
+    struct Frame {
+        int vertex;
+        int arc;
+    };
+
+    std::vector<Frame> stack;
+    std::vector<unsigned int> seen;
+    unsigned int stamp;
+};
+
 template <class V, class E>
 class WeightedGraphEdge;
 
 template <class V, class E>
 class WeightedGraphVertex : public Node<V> {
   public:
-    WeightedGraphVertex() : Node<V>(), list(std::make_shared<LinkList<std::shared_ptr<WeightedGraphEdge<V, E>>>>()) {}
+    WeightedGraphVertex() : Node<V>(), id(0), list(std::make_shared<LinkList<std::shared_ptr<WeightedGraphEdge<V, E>>>>()) {}
+
+    WeightedGraphVertex(V d, int i = 0) : Node<V>(d), id(i), list(std::make_shared<LinkList<std::shared_ptr<WeightedGraphEdge<V, E>>>>()) {}
 
-    WeightedGraphVertex(V d) : Node<V>(d), list(std::make_shared<LinkList<std::shared_ptr<WeightedGraphEdge<V, E>>>>()) {}
+    int getId() const {
+        return id;
+    }
 
     void addEdge(std::shared_ptr<WeightedGraphEdge<V, E>> edge) {
         list->addFromTail(edge);
     }
 
+    template <class F>
+    void forEachEdge(F f) const {
+        list->forEach(f);
+    }
+
     ListNode<std::shared_ptr<WeightedGraphEdge<V, E>>> &operator[](int n) {
         return (*list)[n];
     }
 
   private:
+    int id;
     std::shared_ptr<LinkList<std::shared_ptr<WeightedGraphEdge<V, E>>>> list;
 };
 
@@ -165,7 +327,7 @@ template <class V, class E>
 class WeightedGraph {
   public:
     WeightedGraph()
-        : vertex(std::make_shared<LinkList<std::shared_ptr<WeightedGraphVertex<V, E>>>>()),
+        : vertexCount(0), stale(true), vertex(std::make_shared<LinkList<std::shared_ptr<WeightedGraphVertex<V, E>>>>()),
           edge(std::make_shared<LinkList<std::shared_ptr<WeightedGraphEdge<V, E>>>>()) {}
 
     std::shared_ptr<WeightedGraphVertex<V, E>> operator[](int n) {
@@ -182,73 +344,306 @@ class WeightedGraph {
         if (v1 != v2) {
             v2->addEdge(newEdge);
         }
+        stale = true;
     }
 
     std::shared_ptr<WeightedGraphVertex<V, E>> addVertex(V d) {
-        std::shared_ptr<WeightedGraphVertex<V, E>> v{std::make_shared<WeightedGraphVertex<V, E>>(d)};
+        std::shared_ptr<WeightedGraphVertex<V, E>> v{std::make_shared<WeightedGraphVertex<V, E>>(d, vertexCount)};
         vertex->addFromTail(v);
+        vertexCount++;
+        stale = true;
         return v;
     }
 
+    int size() const {
+        return vertexCount;
+    }
+
     void BFS(std::shared_ptr<WeightedGraphVertex<V, E>> v) {
-        std::unordered_set<std::shared_ptr<WeightedGraphVertex<V, E>>> visited;
-        std::queue<std::shared_ptr<WeightedGraphVertex<V, E>>> q;
-        q.push(v);
-        visited.insert(v);
+        buildAdjacency();
+        std::vector<bool> visited(vertexCount, false);
+        std::vector<int> q{v->getId()};
+        visited[v->getId()] = true;
+
+        for (size_t head{0}; head < q.size(); head++) {
+            int current{q[head]};
+            std::cout << byId[current]->getData() << " ";
+
+            for (int a{offset[current]}; a < offset[current + 1]; a++) {
+                if (!visited[target[a]]) {
+                    visited[target[a]] = true;
+                    q.push_back(target[a]);
+                }
+            }
+        }
+    }
 
-        while (!q.empty()) {
-            std::shared_ptr<WeightedGraphVertex<V, E>> current{q.front()};
-            q.pop();
-            std::cout << current->getData() << " ";
+    // Direction-optimizing BFS over vertex ids. Small frontiers are expanded top-down; once
+    // the frontier's edges outweigh a fraction of the unexplored ones it switches to bottom-up,
+    // where every unvisited vertex scans its own list for a parent in the frontier bitmap.
+    // Large levels are split across `threads` workers (0 = all cores). level[] and parent[]
+    // hold -1 for unreachable vertices; the source has level 0 and parent -1.
+    void BFS(std::shared_ptr<WeightedGraphVertex<V, E>> v, std::vector<int> &level, std::vector<int> &parent, int threads = 0) {
+        buildAdjacency();
+        int n{vertexCount};
+        if (threads <= 0) {
+            threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
 
-            for (int i{0};; i++) {
-                try {
-                    std::shared_ptr<WeightedGraphEdge<V, E>> edge{current->operator[](i).getData()};
-                    std::shared_ptr<WeightedGraphVertex<V, E>> neighbor{edge->getAnotherEnd(current)};
-                    if (visited.find(neighbor) == visited.end()) {
-                        q.push(neighbor);
-                        visited.insert(neighbor);
+        level.assign(n, -1);
+        parent.assign(n, -1);
+
+        AtomicBitmap visited(n);
+        AtomicBitmap front(n);
+        AtomicBitmap next(n);
+        std::vector<int> frontier;
+        std::vector<std::vector<int>> found(threads);
+        std::vector<long long> foundEdges(threads);
+
+        int source{v->getId()};
+        frontier.reserve(n);
+        frontier.push_back(source);
+        visited.set(source);
+        level[source] = 0;
+
+        long long frontierEdges{degree(source)};
+        long long unexplored{static_cast<long long>(target.size()) - frontierEdges};
+        int frontierSize{1};
+        int previousSize{0};
+        bool bottomUp{false};
+
+        for (int depth{0}; frontierSize > 0; depth++) {
+            if (!bottomUp && frontierEdges > unexplored / ALPHA) {
+                front.clear();
+                for (int u : frontier) {
+                    front.set(u);
+                }
+                bottomUp = true;
+            } else if (bottomUp && frontierSize < n / BETA && frontierSize < previousSize) {
+                frontier.clear();
+                for (int u{0}; u < n; u++) {
+                    if (front.test(u)) {
+                        frontier.push_back(u);
                     }
-                } catch (const std::invalid_argument &) {
-                    break;
                 }
+                bottomUp = false;
             }
-        }
-    }
 
-    void DFS(std::shared_ptr<WeightedGraphVertex<V, E>> v) {
-        std::unordered_set<std::shared_ptr<WeightedGraphVertex<V, E>>> visited;
-        std::stack<std::shared_ptr<WeightedGraphVertex<V, E>>> s;
-        s.push(v);
-
-        while (!s.empty()) {
-            std::shared_ptr<WeightedGraphVertex<V, E>> current{s.top()};
-            s.pop();
-
-            if (visited.find(current) == visited.end()) {
-                std::cout << current->getData() << " ";
-                visited.insert(current);
-
-                for (int i{0};; i++) {
-                    try {
-                        std::shared_ptr<WeightedGraphEdge<V, E>> edge{current->operator[](i).getData()};
-                        std::shared_ptr<WeightedGraphVertex<V, E>> neighbor{edge->getAnotherEnd(current)};
-                        s.push(neighbor);
-                    } catch (const std::invalid_argument &) {
-                        break;
+            int work{bottomUp ? n : frontierSize};
+            int used{work >= PARALLEL_WORK ? threads : 1};
+            std::fill(foundEdges.begin(), foundEdges.end(), 0);
+            previousSize = frontierSize;
+            frontierSize = 0;
+
+            if (bottomUp) {
+                std::vector<int> count(used, 0);
+                next.clear();
+                parallelFor(n, used, [&](int t, int lo, int hi) {
+                    for (int u{lo}; u < hi; u++) {
+                        if (visited.test(u)) {
+                            continue;
+                        }
+
+                        for (int a{offset[u]}; a < offset[u + 1]; a++) {
+                            if (front.test(target[a])) {
+                                parent[u] = target[a];
+                                level[u] = depth + 1;
+                                visited.set(u);
+                                next.set(u);
+                                count[t]++;
+                                foundEdges[t] += degree(u);
+                                break;
+                            }
+                        }
+                    }
+                });
+
+                front.swap(next);
+                for (int t{0}; t < used; t++) {
+                    frontierSize += count[t];
+                }
+            } else {
+                parallelFor(frontier.size(), used, [&](int t, int lo, int hi) {
+                    std::vector<int> &out{found[t]};
+                    out.clear();
+                    for (int j{lo}; j < hi; j++) {
+                        int u{frontier[j]};
+                        for (int a{offset[u]}; a < offset[u + 1]; a++) {
+                            int w{target[a]};
+                            if (visited.testAndSet(w)) {
+                                parent[w] = u;
+                                level[w] = depth + 1;
+                                out.push_back(w);
+                                foundEdges[t] += degree(w);
+                            }
+                        }
                     }
+                });
+
+                frontier.clear();
+                for (int t{0}; t < used; t++) {
+                    frontier.insert(frontier.end(), found[t].begin(), found[t].end());
                 }
+                frontierSize = frontier.size();
+            }
+
+            frontierEdges = 0;
+            for (int t{0}; t < used; t++) {
+                frontierEdges += foundEdges[t];
             }
+            unexplored -= frontierEdges;
         }
     }
 
+    void DFS(std::shared_ptr<WeightedGraphVertex<V, E>> v) {
+        DFS(v, [&](int u) { std::cout << byId[u]->getData() << " "; }, [](int) {});
+    }
+
+    // Visits every vertex reachable from v once, calling preorder(id) on the way down
+    // and postorder(id) once all of its neighbours are done
+    template <class Pre, class Post>
+    void DFS(std::shared_ptr<WeightedGraphVertex<V, E>> v, Pre preorder, Post postorder) {
+        buildAdjacency();
+        dfs.reset(vertexCount);
+        dfs.run(
+            v->getId(), offset, target,
+            [&](int u, int) {
+                preorder(u);
+                return true;
+            },
+            [](int, int) { return true; }, postorder);
+    }
+
   private:
+    // Beamer's switching thresholds and the smallest level worth spreading across threads
+    static constexpr int ALPHA{14};
+    static constexpr int BETA{24};
+    static constexpr int PARALLEL_WORK{1 << 14};
+
+    int vertexCount;
+    bool stale;
     std::shared_ptr<LinkList<std::shared_ptr<WeightedGraphVertex<V, E>>>> vertex;
     std::shared_ptr<LinkList<std::shared_ptr<WeightedGraphEdge<V, E>>>> edge;
+
+    // Adjacency flattened by vertex id (neighbours of u are target[offset[u] .. offset[u + 1]),
+    // rebuilt lazily after the graph changes
+    std::vector<std::shared_ptr<WeightedGraphVertex<V, E>>> byId;
+    std::vector<int> offset;
+    std::vector<int> target;
+    DFSEngine dfs;
+
+    long long degree(int u) const {
+        return offset[u + 1] - offset[u];
+    }
+
+    void buildAdjacency() {
+        if (!stale) {
+            return;
+        }
+
+        byId.assign(vertexCount, nullptr);
+        vertex->forEach([&](const std::shared_ptr<WeightedGraphVertex<V, E>> &v) { byId[v->getId()] = v; });
+
+        offset.assign(vertexCount + 1, 0);
+        target.clear();
+        for (int u{0}; u < vertexCount; u++) {
+            byId[u]->forEachEdge([&](const std::shared_ptr<WeightedGraphEdge<V, E>> &e) { target.push_back(e->getAnotherEnd(byId[u])->getId()); });
+            offset[u + 1] = target.size();
+        }
+        stale = false;
+    }
+};
+
+// Edge file written by week10/graphIO.cpp: a 48-byte header, then packed (u, v, w) triples
+struct EdgeFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t vertexCount;
+    uint64_t edgeCount;
+    uint64_t edgeOffset;
+    uint64_t fileSize;
+};
+
+struct FileEdge {
+    uint32_t u;
+    uint32_t v;
+    int32_t w;
 };
 
+// The edge count is checked against the file length before anything is allocated for it
+bool readEdgeFile(const std::string &path, uint32_t &n, std::vector<FileEdge> &edges) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    std::streamoff length{in.tellg()};
+    EdgeFileHeader header;
+    if (length < static_cast<std::streamoff>(sizeof(header)) || !in.seekg(0) || !in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "NDHUEDG1", 8) != 0 || header.version != 1 || header.vertexCount == 0 || header.vertexCount > INT32_MAX ||
+        header.edgeOffset < sizeof(header) || header.edgeOffset > static_cast<uint64_t>(length) ||
+        header.edgeCount > (static_cast<uint64_t>(length) - header.edgeOffset) / sizeof(FileEdge)) {
+        return false;
+    }
+
+    n = static_cast<uint32_t>(header.vertexCount);
+    edges.resize(header.edgeCount);
+    in.seekg(header.edgeOffset);
+    if (!in.read(reinterpret_cast<char *>(edges.data()), edges.size() * sizeof(FileEdge))) {
+        return false;
+    }
+    for (const FileEdge &e : edges) {
+        if (e.u >= n || e.v >= n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// "run <edges file> <bfs|dfs>": times one traversal from vertex 0 and prints algorithm,ms,checksum
+// for week10/graphBenchmark.cpp; the checksum is the number of vertices reached
+int runFile(const std::string &path, const std::string &algorithm) {
+    uint32_t n;
+    std::vector<FileEdge> edges;
+    if (!readEdgeFile(path, n, edges)) {
+        std::cerr << "Could not read " << path << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<WeightedGraph<int, int>> g{std::make_shared<WeightedGraph<int, int>>()};
+    std::vector<std::shared_ptr<WeightedGraphVertex<int, int>>> vertices;
+    for (int j{0}; j < static_cast<int>(n); j++) {
+        vertices.push_back(g->addVertex(j));
+    }
+    for (const FileEdge &e : edges) {
+        g->addLink(vertices[e.u], vertices[e.v], e.w);
+    }
+
+    // The first call flattens the linked adjacency lists, so it is not timed
+    std::vector<int> level;
+    std::vector<int> parent;
+    g->BFS(vertices[0], level, parent, 1);
+
+    long long checksum{0};
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    if (algorithm == "bfs") {
+        g->BFS(vertices[0], level, parent);
+        checksum = std::count_if(level.begin(), level.end(), [](int l) { return l >= 0; });
+    } else if (algorithm == "dfs") {
+        g->DFS(vertices[0], [&](int) { checksum++; }, [](int) {});
+    } else {
+        std::cerr << "Unknown algorithm " << algorithm << std::endl;
+        return 2;
+    }
+    std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() - start};
+
+    std::cout << algorithm << "," << elapsed.count() << "," << checksum << std::endl;
+    return 0;
+}
+
 // My main function to test the graph
-int main(void) {
+int main(int argc, char *argv[]) {
+    if (argc > 3 && std::string(argv[1]) == "run") {
+        return runFile(argv[2], argv[3]);
+    }
+
     try {
         std::shared_ptr<WeightedGraph<char, int>> graph{std::make_shared<WeightedGraph<char, int>>()};
         std::vector<std::shared_ptr<WeightedGraphVertex<char, int>>> vertices;
@@ -301,6 +696,56 @@ int main(void) {
         std::cout << "Starting DFS from vertex " << vertices[startIndex]->getData() << ":\n";
         graph->DFS(vertices[startIndex]);
         std::cout << std::endl;
+
+        std::cout << "DFS postorder from vertex " << vertices[startIndex]->getData() << ":\n";
+        graph->DFS(vertices[startIndex], [](int) {}, [&](int u) { std::cout << char('A' + u) << " "; });
+        std::cout << std::endl;
+
+        std::vector<int> level;
+        std::vector<int> parent;
+        graph->BFS(vertices[startIndex], level, parent);
+        std::cout << "\nBFS levels and parents:" << std::endl;
+        for (int i{0}; i < static_cast<int>(vertices.size()); i++) {
+            std::cout << char('A' + i) << ": level " << level[i] << ", parent " << (parent[i] < 0 ? '-' : char('A' + parent[i])) << std::endl;
+        }
+
+        // Random graph with an average degree of 16
+        const int n{1 << 18};
+        const int m{n * 8};
+        std::shared_ptr<WeightedGraph<int, int>> big{std::make_shared<WeightedGraph<int, int>>()};
+        std::vector<std::shared_ptr<WeightedGraphVertex<int, int>>> bigVertices;
+        std::mt19937 rng(1);
+        for (int j{0}; j < n; j++) {
+            bigVertices.push_back(big->addVertex(j));
+        }
+        for (int j{0}; j < m; j++) {
+            big->addLink(bigVertices[rng() % n], bigVertices[rng() % n], rng() % 100);
+        }
+
+        int cores{static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+        std::cout << "\nBFS on " << n << " vertices, " << m << " edges" << std::endl;
+
+        // The first call also flattens the linked adjacency lists
+        std::chrono::steady_clock::time_point first{std::chrono::steady_clock::now()};
+        big->BFS(bigVertices[0], level, parent);
+        std::chrono::duration<double, std::milli> flatten{std::chrono::steady_clock::now() - first};
+        std::cout << "first call (with flattening): " << flatten.count() << " ms" << std::endl;
+
+        std::cout << "threads,ms,reached,depth" << std::endl;
+        for (int threads{1}; threads <= cores; threads = (threads == cores) ? cores + 1 : std::min(threads * 2, cores)) {
+            std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+            big->BFS(bigVertices[0], level, parent, threads);
+            std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() - start};
+
+            int reached{static_cast<int>(std::count_if(level.begin(), level.end(), [](int l) { return l >= 0; }))};
+            std::cout << threads << "," << elapsed.count() << "," << reached << "," << *std::max_element(level.begin(), level.end()) << std::endl;
+        }
+
+        int visitedCount{0};
+        std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+        big->DFS(bigVertices[0], [&](int) { visitedCount++; }, [](int) {});
+        std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() - start};
+        std::cout << "DFS: " << elapsed.count() << " ms, " << visitedCount << " reached" << std::endl;
     } catch (const std::exception &e) {
         std::cerr << "Error: " << e.what() << std::endl;
     }
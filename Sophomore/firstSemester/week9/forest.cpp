@@ -1,8 +1,17 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <numeric>
+#include <random>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 template <class T>
 class Node {
@@ -84,10 +93,93 @@ class LinkList {
     std::shared_ptr<ListNode<T>> head, tail;
 };
 
+// Iterative depth-first search over a flattened adjacency (the neighbours of u are
+// target[offset[u] .. offset[u + 1])). Each vertex on the current path owns one
+// (vertex, next arc) frame, so nothing is pushed twice and long paths cannot overflow
+// the call stack. The frame stack and visited stamps are kept between traversals.
+class DFSEngine {
+  public:
+    DFSEngine() : stamp(0) {}
+
+    // Starts a new search over n vertices with nothing visited; several run() calls
+    // after one reset() share the visited set
+    void reset(int n) {
+        if (static_cast<int>(seen.size()) < n) {
+            seen.resize(n, 0);
+        }
+        if (++stamp == 0) {
+            std::fill(seen.begin(), seen.end(), 0);
+            stamp = 1;
+        }
+        stack.reserve(n);
+    }
+
+    bool visited(int u) const {
+        return seen[u] == stamp;
+    }
+
+    // onEnter(u, parent) fires in preorder (parent is -1 for the source), onRevisit(u, v)
+    // for every arc u -> v whose end was already discovered, onExit(u) in postorder.
+    // Arcs are tried from the back of each list. A false return from onEnter or onRevisit
+    // stops the search and makes run() return false.
+    template <class Enter, class Revisit, class Exit>
+    bool run(int source, const std::vector<int> &offset, const std::vector<int> &target, Enter onEnter, Revisit onRevisit, Exit onExit) {
+        if (visited(source)) {
+            return true;
+        }
+
+        stack.clear();
+        seen[source] = stamp;
+        if (!onEnter(source, -1)) {
+            return false;
+        }
+        stack.push_back({source, offset[source + 1]});
+
+        while (!stack.empty()) {
+            Frame &top{stack.back()};
+            int u{top.vertex};
+            if (top.arc == offset[u]) {
+                stack.pop_back();
+                onExit(u);
+                continue;
+            }
+
+            int v{target[--top.arc]};
+            if (seen[v] == stamp) {
+                if (!onRevisit(u, v)) {
+                    return false;
+                }
+                continue;
+            }
+
+            seen[v] = stamp;
+            if (!onEnter(v, u)) {
+                return false;
+            }
+            stack.push_back({v, offset[v + 1]});
+        }
+        return true;
+    }
+
+  private:
+    struct Frame {
+        int vertex;
+        int arc;
+    };
+
+    std::vector<Frame> stack;
+    std::vector<unsigned int> seen;
+    unsigned int stamp;
+};
+
 template <class T>
 class GraphNode : public Node<T> {
   public:
-    GraphNode(T d) : Node<T>(d), list(std::make_shared<LinkList<std::shared_ptr<GraphNode<T>>>>()) {}
+    GraphNode(T d, int i = 0) : Node<T>(d), id(i), list(std::make_shared<LinkList<std::shared_ptr<GraphNode<T>>>>()) {}
+
+    int getId() const {
+        return id;
+    }
 
     void addLink(std::shared_ptr<GraphNode<T>> node) {
         list->addFromHead(node);
@@ -98,6 +190,7 @@ class GraphNode : public Node<T> {
     }
 
   private:
+    int id;
     std::shared_ptr<LinkList<std::shared_ptr<GraphNode<T>>>> list;
 };
 
@@ -107,7 +200,12 @@ class Graph {
     Graph() : count(0) {}
 
     std::shared_ptr<GraphNode<T>> addVertex(T d) {
-        std::shared_ptr<GraphNode<T>> node{std::make_shared<GraphNode<T>>(d)};
+        typename std::unordered_map<T, std::shared_ptr<GraphNode<T>>>::iterator found{vertex.find(d)};
+        if (found != vertex.end()) {
+            return found->second;
+        }
+
+        std::shared_ptr<GraphNode<T>> node{std::make_shared<GraphNode<T>>(d, count)};
         vertex[d] = node;
         count++;
         return node;
@@ -118,14 +216,32 @@ class Graph {
         vertex[node2]->addLink(vertex[node1]);
     }
 
+    // A forest has no cycles: walking down from u, the only discovered neighbour allowed
+    // is the parent, reached through exactly one edge. A second edge to the parent or a
+    // self-loop is a cycle as well.
     bool isForest() {
-        std::unordered_map<T, bool> visited;
-        for (const std::pair<T, std::shared_ptr<GraphNode<T>>> &pair : vertex) {
-            visited[pair.first] = false;
-        }
-
-        for (const std::pair<T, std::shared_ptr<GraphNode<T>>> &pair : vertex) {
-            if (!visited[pair.first] && hasCycle(pair.second, nullptr, visited)) {
+        flatten();
+        parent.assign(count, -1);
+        parentEdgeSeen.assign(count, false);
+        dfs.reset(count);
+
+        for (int u{0}; u < count; u++) {
+            bool acyclic{dfs.run(
+                u, offset, target,
+                [&](int v, int p) {
+                    parent[v] = p;
+                    return true;
+                },
+                [&](int v, int w) {
+                    if (w == parent[v] && !parentEdgeSeen[v]) {
+                        parentEdgeSeen[v] = true;
+                        return true;
+                    }
+                    return false;
+                },
+                [](int) {})};
+
+            if (!acyclic) {
                 return false;
             }
         }
@@ -135,23 +251,92 @@ class Graph {
   private:
     std::unordered_map<T, std::shared_ptr<GraphNode<T>>> vertex;
     int count;
+    std::vector<int> offset;
+    std::vector<int> target;
+    std::vector<int> parent;
+    std::vector<bool> parentEdgeSeen;
+    DFSEngine dfs;
+
+    void flatten() {
+        offset.assign(count + 1, 0);
+        for (const std::pair<const T, std::shared_ptr<GraphNode<T>>> &pair : vertex) {
+            for (std::shared_ptr<ListNode<std::shared_ptr<GraphNode<T>>>> current{pair.second->getLinks()->getHead()}; current; current = current->getNext()) {
+                offset[pair.second->getId() + 1]++;
+            }
+        }
+        for (int u{0}; u < count; u++) {
+            offset[u + 1] += offset[u];
+        }
 
-    bool hasCycle(std::shared_ptr<GraphNode<T>> node, std::shared_ptr<GraphNode<T>> parent, std::unordered_map<T, bool> &visited) {
-        visited[node->getData()] = true;
+        std::vector<int> fill(offset.begin(), offset.end() - 1);
+        target.resize(offset[count]);
+        for (const std::pair<const T, std::shared_ptr<GraphNode<T>>> &pair : vertex) {
+            for (std::shared_ptr<ListNode<std::shared_ptr<GraphNode<T>>>> current{pair.second->getLinks()->getHead()}; current; current = current->getNext()) {
+                target[fill[pair.second->getId()]++] = current->getData()->getId();
+            }
+        }
+    }
+};
 
-        std::shared_ptr<ListNode<std::shared_ptr<GraphNode<T>>>> current{node->getLinks()->getHead()};
-        while (current) {
-            std::shared_ptr<GraphNode<T>> neighbor{current->getData()};
+// Online forest check for edge streams too large to store: a union-find over dense vertex
+// ids (union by rank, path compression) decides after every edge whether the graph seen so
+// far is still a forest and how many components it has, in O(V) memory
+class ForestStream {
+  public:
+    explicit ForestStream(int n) : parent(n), rank(n, 0), components(n), forest(true) {
+        std::iota(parent.begin(), parent.end(), 0);
+    }
 
-            if (!visited[neighbor->getData()] && hasCycle(neighbor, node, visited)) {
-                return true;
-            } else if (neighbor != parent) {
-                return true;
-            }
+    // Returns false if the edge closes a cycle; the graph is no longer a forest after that
+    bool addEdge(int u, int v) {
+        int a{find(u)};
+        int b{find(v)};
+        if (a == b) {
+            forest = false;
+            return false;
+        }
 
-            current = current->getNext();
+        if (rank[a] < rank[b]) {
+            std::swap(a, b);
         }
-        return false;
+        parent[b] = a;
+        if (rank[a] == rank[b]) {
+            rank[a]++;
+        }
+        components--;
+        return true;
+    }
+
+    bool connected(int u, int v) {
+        return find(u) == find(v);
+    }
+
+    bool isForest() const {
+        return forest;
+    }
+
+    int componentCount() const {
+        return components;
+    }
+
+  private:
+    std::vector<int> parent;
+    std::vector<unsigned char> rank;
+    int components;
+    bool forest;
+
+    int find(int x) {
+        int root{x};
+        while (parent[root] != root) {
+            root = parent[root];
+        }
+
+        while (parent[x] != root) {
+            int next{parent[x]};
+            parent[x] = root;
+            x = next;
+        }
+        return root;
     }
 };
 
@@ -170,6 +355,11 @@ void runTest(const std::vector<std::pair<char, char>> &edges, int vertexCount, c
 
     bool result{g->isForest()};
 
+    ForestStream stream(vertexCount);
+    for (const std::pair<char, char> &edge : edges) {
+        stream.addEdge(edge.first - 'A', edge.second - 'A');
+    }
+
     std::cout << "Graph Vertices: ";
     for (int i{0}; i < vertexCount; i++) {
         std::cout << static_cast<char>(i + 'A') << " ";
@@ -182,12 +372,99 @@ void runTest(const std::vector<std::pair<char, char>> &edges, int vertexCount, c
     }
     std::cout << std::endl;
 
-    std::cout << "Is Forest: " << (result ? "YES" : "NO") << std::endl
+    std::cout << "Is Forest: " << (result ? "YES" : "NO") << std::endl;
+    std::cout << "Streaming check: " << (stream.isForest() ? "YES" : "NO") << ", " << stream.componentCount() << " component(s)" << std::endl
               << std::endl;
 }
 
+// Edge file written by week10/graphIO.cpp: a 48-byte header, then packed (u, v, w) triples
+struct EdgeFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t vertexCount;
+    uint64_t edgeCount;
+    uint64_t edgeOffset;
+    uint64_t fileSize;
+};
+
+struct FileEdge {
+    uint32_t u;
+    uint32_t v;
+    int32_t w;
+};
+
+// The edge count is checked against the file length before anything is allocated for it
+bool readEdgeFile(const std::string &path, uint32_t &n, std::vector<FileEdge> &edges) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    std::streamoff length{in.tellg()};
+    EdgeFileHeader header;
+    if (length < static_cast<std::streamoff>(sizeof(header)) || !in.seekg(0) || !in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "NDHUEDG1", 8) != 0 || header.version != 1 || header.vertexCount == 0 || header.vertexCount > INT32_MAX ||
+        header.edgeOffset < sizeof(header) || header.edgeOffset > static_cast<uint64_t>(length) ||
+        header.edgeCount > (static_cast<uint64_t>(length) - header.edgeOffset) / sizeof(FileEdge)) {
+        return false;
+    }
+
+    n = static_cast<uint32_t>(header.vertexCount);
+    edges.resize(header.edgeCount);
+    in.seekg(header.edgeOffset);
+    if (!in.read(reinterpret_cast<char *>(edges.data()), edges.size() * sizeof(FileEdge))) {
+        return false;
+    }
+    for (const FileEdge &e : edges) {
+        if (e.u >= n || e.v >= n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// "run <edges file> <forest|stream>": times one forest check and prints algorithm,ms,checksum
+// for week10/graphBenchmark.cpp; the checksum is 1 for a forest and 0 otherwise
+int runFile(const std::string &path, const std::string &algorithm) {
+    uint32_t n;
+    std::vector<FileEdge> edges;
+    if (!readEdgeFile(path, n, edges)) {
+        std::cerr << "Could not read " << path << std::endl;
+        return 1;
+    }
+
+    bool result{true};
+    std::chrono::steady_clock::time_point start;
+    if (algorithm == "forest") {
+        std::shared_ptr<Graph<int>> g{std::make_shared<Graph<int>>()};
+        for (int i{0}; i < static_cast<int>(n); i++) {
+            g->addVertex(i);
+        }
+        for (const FileEdge &e : edges) {
+            g->addLink(e.u, e.v);
+        }
+
+        start = std::chrono::steady_clock::now();
+        result = g->isForest();
+    } else if (algorithm == "stream") {
+        start = std::chrono::steady_clock::now();
+        ForestStream stream(n);
+        for (size_t j{0}; j < edges.size() && result; j++) {
+            result = stream.addEdge(edges[j].u, edges[j].v);
+        }
+    } else {
+        std::cerr << "Unknown algorithm " << algorithm << std::endl;
+        return 2;
+    }
+    std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() - start};
+
+    std::cout << algorithm << "," << elapsed.count() << "," << (result ? 1 : 0) << std::endl;
+    return 0;
+}
+
 // My main function to run the tests
-int main(void) {
+int main(int argc, char *argv[]) {
+    if (argc > 3 && std::string(argv[1]) == "run") {
+        return runFile(argv[2], argv[3]);
+    }
+
     // Test 1: Simple Tree (A - B, B - C)
     runTest({{'A', 'B'}, {'B', 'C'}}, 3, "Simple Tree");
 
@@ -205,6 +482,46 @@ int main(void) {
 
     // Test 6: Large Tree Structure (A - B, B - C, C - D, D - E)
     runTest({{'A', 'B'}, {'B', 'C'}, {'C', 'D'}, {'D', 'E'}}, 5, "Large Tree Structure");
+
+    // Test 7: a path of a million vertices, too deep for a recursive search, then closed into a ring
+    const int n{1000000};
+    std::shared_ptr<Graph<int>> path{std::make_shared<Graph<int>>()};
+    for (int i{0}; i < n; i++) {
+        path->addVertex(i);
+    }
+    for (int i{1}; i < n; i++) {
+        path->addLink(i - 1, i);
+    }
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    bool result{path->isForest()};
+    std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() - start};
+    std::cout << "Path of " << n << " vertices, Is Forest: " << (result ? "YES" : "NO") << " (" << elapsed.count() << " ms)" << std::endl;
+
+    path->addLink(n - 1, 0);
+    std::cout << "Ring of " << n << " vertices, Is Forest: " << (path->isForest() ? "YES" : "NO") << std::endl;
+
+    // Test 8: a random tree streamed edge by edge and never stored, then random extra
+    // edges until one of them closes a cycle
+    const int streamed{1 << 24};
+    std::mt19937 rng(7);
+    ForestStream forest(streamed);
+
+    start = std::chrono::steady_clock::now();
+    for (int i{1}; i < streamed; i++) {
+        forest.addEdge(i, rng() % i);
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Streamed " << streamed - 1 << " tree edges in " << elapsed.count() << " ms, Is Forest: " << (forest.isForest() ? "YES" : "NO")
+              << ", components: " << forest.componentCount() << std::endl;
+
+    ForestStream sparse(streamed);
+    long long edges{0};
+    while (sparse.addEdge(rng() % streamed, rng() % streamed)) {
+        edges++;
+    }
+    std::cout << "Random edges on " << streamed << " vertices: first cycle after " << edges << " edges, components: " << sparse.componentCount()
+              << std::endl;
 }
 
 /*
@@ -1,10 +1,22 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <limits>
+#include <list>
 #include <memory>
+#include <numeric>
 #include <queue>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 template <class T>
@@ -203,15 +215,32 @@ class LinkList {
     std::shared_ptr<ListNode<T>> tail;
 };
 
+// Runs f(lo, hi) on `threads` contiguous slices of [0, n)
+template <class F>
+void parallelFor(int n, int threads, F f) {
+    std::vector<std::thread> pool;
+    int chunk{(n + threads - 1) / threads};
+    for (int lo{0}; lo < n; lo += chunk) {
+        pool.emplace_back(f, lo, std::min(n, lo + chunk));
+    }
+    for (std::thread &t : pool) {
+        t.join();
+    }
+}
+
 template <class V, class E>
 class WeightedGraphEdge;
 
 template <class V, class E>
 class WeightedGraphVertex : public Node<V> {
   public:
-    WeightedGraphVertex() : Node<V>(), list(std::make_shared<LinkList<WeightedGraphEdge<V, E> *>>()) {}
+    WeightedGraphVertex() : Node<V>(), id(0), list(std::make_shared<LinkList<WeightedGraphEdge<V, E> *>>()) {}
 
-    WeightedGraphVertex(V d) : Node<V>(d), list(std::make_shared<LinkList<WeightedGraphEdge<V, E> *>>()) {}
+    WeightedGraphVertex(V d, int i = 0) : Node<V>(d), id(i), list(std::make_shared<LinkList<WeightedGraphEdge<V, E> *>>()) {}
+
+    int getId() const {
+        return id;
+    }
 
     void addEdge(std::shared_ptr<WeightedGraphEdge<V, E>> edge) {
         list->addFromTail(edge.get());
@@ -232,6 +261,7 @@ class WeightedGraphVertex : public Node<V> {
     }
 
   private:
+    int id;
     std::shared_ptr<LinkList<WeightedGraphEdge<V, E> *>> list;
 };
 
@@ -249,6 +279,10 @@ class WeightedGraphEdge : public Node<E> {
         return (v != end[0]) ? end[0] : end[1];
     }
 
+    std::shared_ptr<WeightedGraphVertex<V, E>> getEnd(int i) const {
+        return end[i];
+    }
+
   private:
     std::shared_ptr<WeightedGraphVertex<V, E>> end[2];
 };
@@ -283,16 +317,17 @@ class WeightedGraph {
         }
 
         this->edge->addFromTail(edge);
+        edgeCount++;
     }
 
     std::shared_ptr<WeightedGraphVertex<V, E>> addVertex(V d) {
-        for (std::shared_ptr<ListNode<std::shared_ptr<WeightedGraphVertex<V, E>>>> j{vertex->head}; j != nullptr; j = j->getNext()) {
-            if (j->getData()->getData() == d) {
-                return j->getData();
-            }
+        typename std::unordered_map<V, std::shared_ptr<WeightedGraphVertex<V, E>>>::iterator found{index.find(d)};
+        if (found != index.end()) {
+            return found->second;
         }
-        std::shared_ptr<WeightedGraphVertex<V, E>> v{std::make_shared<WeightedGraphVertex<V, E>>(d)};
+        std::shared_ptr<WeightedGraphVertex<V, E>> v{std::make_shared<WeightedGraphVertex<V, E>>(d, vertexCount)};
         vertex->addFromTail(v);
+        index[d] = v;
         vertexCount++;
 
         return v;
@@ -306,7 +341,7 @@ class WeightedGraph {
             std::shared_ptr<ListNode<WeightedGraphEdge<V, E> *>> e{(*temp)[0]};
 
             while (e != nullptr) {
-                std::cout << e->getData()->getAnotherEnd(temp) << "(" << e->getData()->getData() << ") ";
+                std::cout << *e->getData()->getAnotherEnd(temp) << "(" << e->getData()->getData() << ") ";
                 e = e->getNext();
             }
 
@@ -315,18 +350,465 @@ class WeightedGraph {
         }
     }
 
+    // Sum of the edge weights; integer weights add up in long long, since a tree of millions
+    // of int edges passes INT_MAX
+    std::common_type_t<E, long long> totalWeight() const {
+        std::common_type_t<E, long long> total{0};
+        for (std::shared_ptr<ListNode<std::shared_ptr<WeightedGraphEdge<V, E>>>> e{edge->head}; e != nullptr; e = e->getNext()) {
+            total += e->getData()->getData();
+        }
+        return total;
+    }
+
+    // Spanning tree of the component containing start. Small graphs use Prim, large
+    // ones parallel Boruvka, which only pays for its thread start-up on many edges.
     std::shared_ptr<WeightedGraph> minimumSpanningTree(std::shared_ptr<WeightedGraphVertex<V, E>> start) {
-        return nullptr;
+        int threads{static_cast<int>(std::thread::hardware_concurrency())};
+        if (threads > 1 && edgeCount >= PARALLEL_EDGES) {
+            return boruvkaTree(start, threads);
+        }
+        return primTree(start);
+    }
+
+    // Prim with a lazy binary heap over a flattened adjacency array, O(E log E)
+    std::shared_ptr<WeightedGraph> primTree(std::shared_ptr<WeightedGraphVertex<V, E>> start) {
+        std::vector<std::shared_ptr<WeightedGraphVertex<V, E>>> vertices;
+        std::vector<FlatEdge> edges;
+        flatten(vertices, edges);
+
+        std::vector<int> offset(vertexCount + 1, 0);
+        for (const FlatEdge &e : edges) {
+            offset[e.u + 1]++;
+            offset[e.v + 1]++;
+        }
+        std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+        std::vector<int> arc(offset[vertexCount]);
+        std::vector<int> cursor(offset.begin(), offset.end() - 1);
+        for (int j{0}; j < static_cast<int>(edges.size()); j++) {
+            arc[cursor[edges[j].u]++] = j;
+            arc[cursor[edges[j].v]++] = j;
+        }
+
+        std::vector<bool> inTree(vertexCount, false);
+        std::vector<int> chosen;
+        std::priority_queue<std::pair<E, int>, std::vector<std::pair<E, int>>, std::greater<std::pair<E, int>>> pq;
+
+        int u{start->getId()};
+        inTree[u] = true;
+        while (true) {
+            for (int a{offset[u]}; a < offset[u + 1]; a++) {
+                const FlatEdge &e{edges[arc[a]]};
+                if (!inTree[e.u] || !inTree[e.v]) {
+                    pq.push({e.w, arc[a]});
+                }
+            }
+
+            u = -1;
+            while (!pq.empty() && u == -1) {
+                int j{pq.top().second};
+                pq.pop();
+                if (!inTree[edges[j].u]) {
+                    u = edges[j].u;
+                } else if (!inTree[edges[j].v]) {
+                    u = edges[j].v;
+                } else {
+                    continue;
+                }
+                inTree[u] = true;
+                chosen.push_back(j);
+            }
+
+            if (u == -1) {
+                break;
+            }
+        }
+
+        return buildTree(vertices, edges, chosen, inTree);
+    }
+
+    // Boruvka: every round each component picks its lightest outgoing edge in parallel
+    // (ties broken by edge index, so the picks never close a cycle), the picks are merged
+    // with union-find by size and every vertex takes its root as its new component label.
+    // At most log V rounds.
+    std::shared_ptr<WeightedGraph> boruvkaTree(std::shared_ptr<WeightedGraphVertex<V, E>> start, int threads) {
+        std::vector<std::shared_ptr<WeightedGraphVertex<V, E>>> vertices;
+        std::vector<FlatEdge> edges;
+        flatten(vertices, edges);
+
+        int n{vertexCount};
+        int m{static_cast<int>(edges.size())};
+        threads = std::max(1, threads);
+
+        std::vector<int> parent(n);
+        std::vector<int> size(n, 1);
+        std::vector<int> comp(n);
+        std::vector<std::atomic<int>> cheapest(n);
+        std::vector<int> chosen;
+        std::iota(parent.begin(), parent.end(), 0);
+        std::iota(comp.begin(), comp.end(), 0);
+
+        std::function<int(int)> find{[&](int x) {
+            while (parent[x] != x) {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        }};
+
+        bool merged{true};
+        while (merged) {
+            parallelFor(n, threads, [&](int lo, int hi) {
+                for (int c{lo}; c < hi; c++) {
+                    cheapest[c].store(-1, std::memory_order_relaxed);
+                }
+            });
+
+            parallelFor(m, threads, [&](int lo, int hi) {
+                for (int j{lo}; j < hi; j++) {
+                    int cu{comp[edges[j].u]};
+                    int cv{comp[edges[j].v]};
+                    if (cu != cv) {
+                        offer(cheapest[cu], j, edges);
+                        offer(cheapest[cv], j, edges);
+                    }
+                }
+            });
+
+            merged = false;
+            for (int c{0}; c < n; c++) {
+                int j{cheapest[c].load(std::memory_order_relaxed)};
+                if (j == -1) {
+                    continue;
+                }
+
+                int ru{find(edges[j].u)};
+                int rv{find(edges[j].v)};
+                if (ru != rv) {
+                    if (size[ru] > size[rv]) {
+                        std::swap(ru, rv);
+                    }
+                    parent[ru] = rv;
+                    size[rv] += size[ru];
+                    chosen.push_back(j);
+                    merged = true;
+                }
+            }
+
+            // find() compresses as it goes, so this pass is near-linear; it stays serial
+            // because path halving writes to parent
+            for (int v{0}; v < n; v++) {
+                comp[v] = find(v);
+            }
+        }
+
+        std::vector<bool> inTree(n, false);
+        for (int v{0}; v < n; v++) {
+            inTree[v] = (comp[v] == comp[start->getId()]);
+        }
+
+        std::vector<int> component;
+        for (int j : chosen) {
+            if (inTree[edges[j].u]) {
+                component.push_back(j);
+            }
+        }
+
+        return buildTree(vertices, edges, component, inTree);
     }
 
   private:
+    static constexpr int PARALLEL_EDGES{1 << 18};
+
+    struct FlatEdge {
+        int u;
+        int v;
+        E w;
+    };
+
     int vertexCount;
     int edgeCount;
     std::shared_ptr<LinkList<std::shared_ptr<WeightedGraphVertex<V, E>>>> vertex;
     std::shared_ptr<LinkList<std::shared_ptr<WeightedGraphEdge<V, E>>>> edge;
+    std::unordered_map<V, std::shared_ptr<WeightedGraphVertex<V, E>>> index;
+
+    void flatten(std::vector<std::shared_ptr<WeightedGraphVertex<V, E>>> &vertices, std::vector<FlatEdge> &edges) {
+        vertices.reserve(vertexCount);
+        for (std::shared_ptr<ListNode<std::shared_ptr<WeightedGraphVertex<V, E>>>> v{vertex->head}; v != nullptr; v = v->getNext()) {
+            vertices.push_back(v->getData());
+        }
+
+        edges.reserve(edgeCount);
+        for (std::shared_ptr<ListNode<std::shared_ptr<WeightedGraphEdge<V, E>>>> e{edge->head}; e != nullptr; e = e->getNext()) {
+            edges.push_back({e->getData()->getEnd(0)->getId(), e->getData()->getEnd(1)->getId(), e->getData()->getData()});
+        }
+    }
+
+    static void offer(std::atomic<int> &slot, int j, const std::vector<FlatEdge> &edges) {
+        int current{slot.load(std::memory_order_relaxed)};
+        while (current == -1 || edges[j].w < edges[current].w || (edges[j].w == edges[current].w && j < current)) {
+            if (slot.compare_exchange_weak(current, j, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    std::shared_ptr<WeightedGraph> buildTree(const std::vector<std::shared_ptr<WeightedGraphVertex<V, E>>> &vertices, const std::vector<FlatEdge> &edges,
+                                             const std::vector<int> &chosen, const std::vector<bool> &inTree) {
+        std::shared_ptr<WeightedGraph> tree{std::make_shared<WeightedGraph>()};
+        std::vector<std::shared_ptr<WeightedGraphVertex<V, E>>> copy(vertices.size());
+        for (int v{0}; v < static_cast<int>(vertices.size()); v++) {
+            if (inTree[v]) {
+                copy[v] = tree->addVertex(vertices[v]->getData());
+            }
+        }
+
+        for (int j : chosen) {
+            tree->addLink(copy[edges[j].u], copy[edges[j].v], edges[j].w);
+        }
+        return tree;
+    }
 };
 
-int main(void) {
+// Sequential baselines, copied from AlgoDesign/foreCastLab4.cpp
+typedef int WeightType;
+
+struct Edge {
+    int u, v;
+    WeightType w;
+    bool operator>(const Edge &other) const { return w > other.w; }
+};
+
+struct Graph {
+    Graph(int n) : E(n) {}
+    std::vector<std::list<Edge>> E;
+
+    void add_edge(int u, int v, WeightType w) {
+        E[u].push_back({u, v, w});
+        E[v].push_back({v, u, w});
+    }
+
+    int n() const { return E.size(); }
+
+    int m() const {
+        int res{0};
+        for (const std::list<Edge> &list : E)
+            res += list.size();
+        return res / 2;
+    }
+};
+
+// Prim's MST Algorithm
+Graph primMST(const Graph &G) {
+    std::priority_queue<Edge, std::vector<Edge>, std::greater<Edge>> pq;
+    Graph MST(G.n());
+    std::vector<bool> visited(G.n(), false);
+
+    // Start with vertex 0
+    visited[0] = true;
+    for (const Edge &e : G.E[0])
+        pq.push(e);
+
+    while (!pq.empty()) {
+        Edge e{pq.top()};
+        pq.pop();
+
+        if (visited[e.u] && visited[e.v])
+            continue;
+
+        int new_vertex{visited[e.u] ? e.v : e.u};
+        visited[new_vertex] = true;
+        MST.add_edge(e.u, e.v, e.w);
+
+        for (const Edge &edge : G.E[new_vertex]) {
+            if (!visited[edge.v])
+                pq.push(edge);
+        }
+    }
+
+    return MST;
+}
+
+// Disjoint Set Union for Kruskal's
+class DSU {
+    std::vector<int> parent;
+    std::vector<int> rank;
+
+  public:
+    DSU(int n) : parent(n), rank(n, 0) {
+        for (int i{0}; i < n; i++)
+            parent[i] = i;
+    }
+
+    int find(int u) {
+        if (parent[u] != u)
+            parent[u] = find(parent[u]);
+        return parent[u];
+    }
+
+    bool unite(int u, int v) {
+        int root_u{find(u)};
+        int root_v{find(v)};
+
+        if (root_u == root_v)
+            return false; // Useless edge
+
+        if (rank[root_u] < rank[root_v])
+            parent[root_u] = root_v;
+        else if (rank[root_u] > rank[root_v])
+            parent[root_v] = root_u;
+        else {
+            parent[root_v] = root_u;
+            rank[root_u]++;
+        }
+        return true; // Safe edge
+    }
+};
+
+// Kruskal's MST Algorithm
+Graph kruskalMST(const Graph &G) {
+    Graph MST(G.n());
+    DSU dsu(G.n());
+    std::vector<Edge> edges;
+
+    // Collect all edges
+    for (int u{0}; u < G.n(); u++)
+        for (const Edge &e : G.E[u])
+            if (e.u < e.v) // Avoid duplicates
+                edges.push_back(e);
+
+    // Sort edges by weight
+    std::sort(edges.begin(), edges.end(),
+              [](const Edge &a, const Edge &b) { return a.w < b.w; });
+
+    // Process edges in order
+    for (const Edge &e : edges) {
+        if (dsu.unite(e.u, e.v)) { // Only add if not useless
+            MST.add_edge(e.u, e.v, e.w);
+        }
+    }
+
+    return MST;
+}
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Edge file written by week10/graphIO.cpp: a 48-byte header, then packed (u, v, w) triples
+struct EdgeFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t vertexCount;
+    uint64_t edgeCount;
+    uint64_t edgeOffset;
+    uint64_t fileSize;
+};
+
+struct FileEdge {
+    uint32_t u;
+    uint32_t v;
+    int32_t w;
+};
+
+// The edge count is checked against the file length before anything is allocated for it
+bool readEdgeFile(const std::string &path, uint32_t &n, std::vector<FileEdge> &edges) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    std::streamoff length{in.tellg()};
+    EdgeFileHeader header;
+    if (length < static_cast<std::streamoff>(sizeof(header)) || !in.seekg(0) || !in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "NDHUEDG1", 8) != 0 || header.version != 1 || header.vertexCount == 0 || header.vertexCount > INT32_MAX ||
+        header.edgeOffset < sizeof(header) || header.edgeOffset > static_cast<uint64_t>(length) ||
+        header.edgeCount > (static_cast<uint64_t>(length) - header.edgeOffset) / sizeof(FileEdge)) {
+        return false;
+    }
+
+    n = static_cast<uint32_t>(header.vertexCount);
+    edges.resize(header.edgeCount);
+    in.seekg(header.edgeOffset);
+    if (!in.read(reinterpret_cast<char *>(edges.data()), edges.size() * sizeof(FileEdge))) {
+        return false;
+    }
+    for (const FileEdge &e : edges) {
+        if (e.u >= n || e.v >= n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// "run <edges file> <prim|boruvka|lab4-prim|lab4-kruskal>": times one MST and prints
+// algorithm,ms,checksum for week10/graphBenchmark.cpp. The checksum is the weight of the
+// tree spanning vertex 0's component; Kruskal builds the whole forest, so its other trees
+// are left out.
+int runFile(const std::string &path, const std::string &algorithm) {
+    uint32_t n;
+    std::vector<FileEdge> edges;
+    if (!readEdgeFile(path, n, edges)) {
+        std::cerr << "Could not read " << path << std::endl;
+        return 1;
+    }
+
+    long long checksum{0};
+    std::chrono::steady_clock::time_point start;
+    if (algorithm == "prim" || algorithm == "boruvka") {
+        std::shared_ptr<WeightedGraph<int, int>> g{std::make_shared<WeightedGraph<int, int>>()};
+        std::vector<std::shared_ptr<WeightedGraphVertex<int, int>>> vertices;
+        for (int j{0}; j < static_cast<int>(n); j++) {
+            vertices.push_back(g->addVertex(j));
+        }
+        for (const FileEdge &e : edges) {
+            g->addLink(vertices[e.u], vertices[e.v], e.w);
+        }
+
+        int threads{static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+        start = std::chrono::steady_clock::now();
+        std::shared_ptr<WeightedGraph<int, int>> tree{algorithm == "prim" ? g->primTree(vertices[0]) : g->boruvkaTree(vertices[0], threads)};
+        checksum = tree->totalWeight();
+    } else if (algorithm == "lab4-prim" || algorithm == "lab4-kruskal") {
+        Graph G(n);
+        for (const FileEdge &e : edges) {
+            G.add_edge(e.u, e.v, e.w);
+        }
+
+        std::vector<char> component(n, 0);
+        std::vector<int> stack{0};
+        component[0] = 1;
+        while (!stack.empty()) {
+            int u{stack.back()};
+            stack.pop_back();
+            for (const Edge &e : G.E[u]) {
+                if (!component[e.v]) {
+                    component[e.v] = 1;
+                    stack.push_back(e.v);
+                }
+            }
+        }
+
+        start = std::chrono::steady_clock::now();
+        Graph tree{algorithm == "lab4-prim" ? primMST(G) : kruskalMST(G)};
+        for (int u{0}; u < static_cast<int>(n); u++) {
+            for (const Edge &e : tree.E[u]) {
+                checksum += component[u] ? e.w : 0;
+            }
+        }
+        checksum /= 2;
+    } else {
+        std::cerr << "Unknown algorithm " << algorithm << std::endl;
+        return 2;
+    }
+    double elapsed{elapsedSince(start)};
+
+    std::cout << algorithm << "," << elapsed << "," << checksum << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 3 && std::string(argv[1]) == "run") {
+        return runFile(argv[2], argv[3]);
+    }
+
     std::shared_ptr<WeightedGraph<char, int>> g{std::make_shared<WeightedGraph<char, int>>()};
     std::shared_ptr<WeightedGraph<char, int>> tree;
 
@@ -353,4 +835,55 @@ int main(void) {
 
     tree = g->minimumSpanningTree((*g)[0]);
     tree->adjList();
+
+    // Benchmark on a random graph against the foreCastLab4 implementations
+    const int n{100000};
+    const int m{1000000};
+    std::shared_ptr<WeightedGraph<int, int>> big{std::make_shared<WeightedGraph<int, int>>()};
+    std::vector<std::shared_ptr<WeightedGraphVertex<int, int>>> vertices;
+    Graph G(n);
+
+    for (int j{0}; j < n; j++) {
+        vertices.push_back(big->addVertex(j));
+    }
+    for (int j{0}; j < m; j++) {
+        int u{rand() % n};
+        int v{rand() % n};
+        int w{rand() % 1000 + 1};
+        big->addLink(vertices[u], vertices[v], w);
+        G.add_edge(u, v, w);
+    }
+
+    int threads{static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+    std::cout << std::endl
+              << "Random graph: " << n << " vertices, " << m << " edges, " << threads << " threads" << std::endl;
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    std::shared_ptr<WeightedGraph<int, int>> bigTree{big->primTree(vertices[0])};
+    std::cout << "primTree:    " << elapsedSince(start) << " ms, weight " << bigTree->totalWeight() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    bigTree = big->boruvkaTree(vertices[0], threads);
+    std::cout << "boruvkaTree: " << elapsedSince(start) << " ms, weight " << bigTree->totalWeight() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    Graph prim{primMST(G)};
+    double primTime{elapsedSince(start)};
+
+    start = std::chrono::steady_clock::now();
+    Graph kruskal{kruskalMST(G)};
+    double kruskalTime{elapsedSince(start)};
+
+    long long primWeight{0};
+    long long kruskalWeight{0};
+    for (int u{0}; u < n; u++) {
+        for (const Edge &e : prim.E[u]) {
+            primWeight += e.w;
+        }
+        for (const Edge &e : kruskal.E[u]) {
+            kruskalWeight += e.w;
+        }
+    }
+    std::cout << "primMST:     " << primTime << " ms, weight " << primWeight / 2 << std::endl;
+    std::cout << "kruskalMST:  " << kruskalTime << " ms, weight " << kruskalWeight / 2 << std::endl;
 }
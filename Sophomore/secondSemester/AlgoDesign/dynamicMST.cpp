@@ -0,0 +1,517 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <random>
+#include <vector>
+
+typedef int WeightType;
+
+// Graph representation and Kruskal, copied from foreCastLab4.cpp
+struct Edge {
+    int u, v;
+    WeightType w;
+    bool operator>(const Edge &other) const { return w > other.w; }
+};
+
+struct Graph {
+    Graph(int n) : E(n) {}
+    std::vector<std::list<Edge>> E;
+
+    void add_edge(int u, int v, WeightType w) {
+        E[u].push_back({u, v, w});
+        E[v].push_back({v, u, w});
+    }
+
+    int n() const { return E.size(); }
+
+    int m() const {
+        int res{0};
+        for (const std::list<Edge> &list : E)
+            res += list.size();
+        return res / 2;
+    }
+};
+
+class DSU {
+    std::vector<int> parent;
+    std::vector<int> rank;
+
+  public:
+    DSU(int n) : parent(n), rank(n, 0) {
+        for (int i{0}; i < n; i++)
+            parent[i] = i;
+    }
+
+    int find(int u) {
+        if (parent[u] != u)
+            parent[u] = find(parent[u]);
+        return parent[u];
+    }
+
+    bool unite(int u, int v) {
+        int root_u{find(u)};
+        int root_v{find(v)};
+
+        if (root_u == root_v)
+            return false;
+
+        if (rank[root_u] < rank[root_v])
+            parent[root_u] = root_v;
+        else if (rank[root_u] > rank[root_v])
+            parent[root_v] = root_u;
+        else {
+            parent[root_v] = root_u;
+            rank[root_u]++;
+        }
+        return true;
+    }
+};
+
+Graph kruskalMST(const Graph &G) {
+    Graph MST(G.n());
+    DSU dsu(G.n());
+    std::vector<Edge> edges;
+
+    for (int u{0}; u < G.n(); u++)
+        for (const Edge &e : G.E[u])
+            if (e.u < e.v)
+                edges.push_back(e);
+
+    std::sort(edges.begin(), edges.end(),
+              [](const Edge &a, const Edge &b) { return a.w < b.w; });
+
+    for (const Edge &e : edges) {
+        if (dsu.unite(e.u, e.v))
+            MST.add_edge(e.u, e.v, e.w);
+    }
+
+    return MST;
+}
+
+// Minimum spanning forest under edge insertions and deletions.
+//
+// The forest lives in a link-cut tree in which every forest edge is a node of its own
+// between its endpoints, so a path query returns the heaviest edge on the tree path.
+// Inserting (u, v, w) links it if u and v are in different trees; otherwise it replaces
+// the heaviest edge on the u-v path if that one is heavier, and is a useless edge if not.
+// Both take O(log n) amortized.
+//
+// Deleting a non-tree edge only drops it. Deleting a forest edge splits its tree; the
+// replacement is the lightest non-tree edge leaving the smaller half. The two halves are
+// searched in lockstep over the forest edges, so the search stops after O(smaller half)
+// vertices, and only the non-tree edges of that half are scanned. Ties between equal
+// weights are broken by edge id, which keeps the forest unique.
+class DynamicForest {
+  public:
+    explicit DynamicForest(int n)
+        : vertices(n), incident(n), seen(n, 0), stamp(0), total(0), treeEdges(0),
+          left(n, NIL), right(n, NIL), up(n, NIL), flip(n, false), heaviest(n) {
+        for (int v{0}; v < n; v++)
+            heaviest[v] = v;
+    }
+
+    int n() const { return vertices; }
+
+    long long weight() const { return total; }
+
+    int forestEdgeCount() const { return treeEdges; }
+
+    bool inForest(int id) const { return edges[id].inTree; }
+
+    bool connected(int u, int v) { return u == v || findRoot(u) == findRoot(v); }
+
+    // Returns the id of the new edge, which stays valid until the edge is deleted
+    int insertEdge(int u, int v, WeightType w) {
+        int id{newEdge(u, v, w)};
+        if (u == v)
+            return id;
+
+        if (!connected(u, v)) {
+            linkEdge(id);
+            return id;
+        }
+
+        makeRoot(u);
+        access(v);
+        splay(v);
+        int worst{heaviest[v] - vertices};
+        if (heavier(id + vertices, worst + vertices))
+            return id;
+
+        cutEdge(worst);
+        linkEdge(id);
+        return id;
+    }
+
+    void deleteEdge(int id) {
+        EdgeRecord &e{edges[id]};
+        bool wasTree{e.inTree};
+        if (wasTree)
+            cutEdge(id);
+        detach(id);
+        e.alive = false;
+        freeIds.push_back(id);
+
+        if (wasTree) {
+            int replacement{findReplacement(e.u, e.v)};
+            if (replacement != NIL)
+                linkEdge(replacement);
+        }
+    }
+
+    // The current forest as a list of edges
+    std::vector<Edge> forest() const {
+        std::vector<Edge> result;
+        for (const EdgeRecord &e : edges)
+            if (e.alive && e.inTree)
+                result.push_back({e.u, e.v, e.w});
+        return result;
+    }
+
+    // Every edge that has not been deleted, in the forest or not
+    std::vector<Edge> graphEdges() const {
+        std::vector<Edge> result;
+        for (const EdgeRecord &e : edges)
+            if (e.alive)
+                result.push_back({e.u, e.v, e.w});
+        return result;
+    }
+
+  private:
+    static constexpr int NIL{-1};
+
+    struct EdgeRecord {
+        int u, v;
+        WeightType w;
+        bool alive;
+        bool inTree;
+        int slotU, slotV; // positions in incident[u] and incident[v]
+    };
+
+    int vertices;
+    std::vector<EdgeRecord> edges;
+    std::vector<int> freeIds;
+    std::vector<std::vector<int>> incident;
+    std::vector<unsigned> seen;
+    unsigned stamp;
+    long long total;
+    int treeEdges;
+
+    // Link-cut tree over vertices [0, n) and edge nodes [n, n + edges); a splay tree per
+    // preferred path, `up` is the splay parent or the path-parent pointer
+    std::vector<int> left, right, up;
+    std::vector<bool> flip;
+    std::vector<int> heaviest;
+    std::vector<int> path;
+
+    int newEdge(int u, int v, WeightType w) {
+        int id;
+        if (freeIds.empty()) {
+            id = edges.size();
+            edges.push_back({});
+            left.push_back(NIL);
+            right.push_back(NIL);
+            up.push_back(NIL);
+            flip.push_back(false);
+            heaviest.push_back(0);
+        } else {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+
+        int node{id + vertices};
+        left[node] = right[node] = up[node] = NIL;
+        flip[node] = false;
+        heaviest[node] = node;
+
+        edges[id] = {u, v, w, true, false, static_cast<int>(incident[u].size()), static_cast<int>(incident[v].size())};
+
+        // A self-loop can never join the forest, so it is kept out of the incidence lists
+        if (u != v) {
+            incident[u].push_back(id);
+            incident[v].push_back(id);
+        }
+        return id;
+    }
+
+    // Removes the edge from both incidence lists by moving the last entry into its slot
+    void detach(int id) {
+        if (edges[id].u == edges[id].v)
+            return;
+        removeSlot(edges[id].u, edges[id].slotU);
+        removeSlot(edges[id].v, edges[id].slotV);
+    }
+
+    void removeSlot(int vertex, int slot) {
+        std::vector<int> &list{incident[vertex]};
+        int moved{list.back()};
+        list[slot] = moved;
+        list.pop_back();
+        if (edges[moved].u == vertex)
+            edges[moved].slotU = slot;
+        else
+            edges[moved].slotV = slot;
+    }
+
+    // Edge nodes compare by (weight, id); vertex nodes are lighter than every edge
+    bool heavier(int a, int b) const {
+        if (a < vertices || b < vertices)
+            return b < vertices && a >= vertices;
+        const EdgeRecord &x{edges[a - vertices]};
+        const EdgeRecord &y{edges[b - vertices]};
+        return x.w != y.w ? x.w > y.w : a > b;
+    }
+
+    void linkEdge(int id) {
+        int node{id + vertices};
+        makeRoot(edges[id].u);
+        up[edges[id].u] = node;
+        makeRoot(node);
+        up[node] = edges[id].v;
+        edges[id].inTree = true;
+        total += edges[id].w;
+        treeEdges++;
+    }
+
+    void cutEdge(int id) {
+        int node{id + vertices};
+        cut(edges[id].u, node);
+        cut(node, edges[id].v);
+        edges[id].inTree = false;
+        total -= edges[id].w;
+        treeEdges--;
+    }
+
+    // Grows one search from each endpoint of the deleted edge, a vertex at a time, until
+    // one side runs out; that side is the whole smaller tree. Side s marks its vertices
+    // with stamp + s.
+    int findReplacement(int u, int v) {
+        if (stamp >= UINT_MAX - 2) {
+            std::fill(seen.begin(), seen.end(), 0);
+            stamp = 0;
+        }
+        stamp += 2;
+
+        std::vector<int> side[2]{{u}, {v}};
+        size_t head[2]{0, 0};
+        seen[u] = stamp;
+        seen[v] = stamp + 1;
+        int smaller{NIL};
+        while (smaller == NIL) {
+            for (int s{0}; s < 2; s++) {
+                if (head[s] == side[s].size()) {
+                    smaller = s;
+                    break;
+                }
+                int x{side[s][head[s]++]};
+                for (int id : incident[x]) {
+                    const EdgeRecord &e{edges[id]};
+                    int y{e.u == x ? e.v : e.u};
+                    if (e.inTree && seen[y] != stamp + s) {
+                        seen[y] = stamp + s;
+                        side[s].push_back(y);
+                    }
+                }
+            }
+        }
+
+        // Every non-tree edge joins two vertices of the old tree, so it crosses the cut
+        // exactly when one end is on the smaller side
+        unsigned mark{stamp + smaller};
+        int best{NIL};
+        for (int x : side[smaller]) {
+            for (int id : incident[x]) {
+                const EdgeRecord &e{edges[id]};
+                if (!e.inTree && (seen[e.u] == mark) != (seen[e.v] == mark) && (best == NIL || heavier(best + vertices, id + vertices)))
+                    best = id;
+            }
+        }
+        return best;
+    }
+
+    bool isSplayRoot(int x) const {
+        int p{up[x]};
+        return p == NIL || (left[p] != x && right[p] != x);
+    }
+
+    void pushDown(int x) {
+        if (!flip[x])
+            return;
+        std::swap(left[x], right[x]);
+        if (left[x] != NIL)
+            flip[left[x]] = !flip[left[x]];
+        if (right[x] != NIL)
+            flip[right[x]] = !flip[right[x]];
+        flip[x] = false;
+    }
+
+    void pull(int x) {
+        heaviest[x] = x;
+        if (left[x] != NIL && heavier(heaviest[left[x]], heaviest[x]))
+            heaviest[x] = heaviest[left[x]];
+        if (right[x] != NIL && heavier(heaviest[right[x]], heaviest[x]))
+            heaviest[x] = heaviest[right[x]];
+    }
+
+    void rotate(int x) {
+        int p{up[x]};
+        int g{up[p]};
+        bool pRoot{isSplayRoot(p)};
+        if (left[p] == x) {
+            left[p] = right[x];
+            if (right[x] != NIL)
+                up[right[x]] = p;
+            right[x] = p;
+        } else {
+            right[p] = left[x];
+            if (left[x] != NIL)
+                up[left[x]] = p;
+            left[x] = p;
+        }
+        up[p] = x;
+        up[x] = g;
+        if (!pRoot) {
+            if (left[g] == p)
+                left[g] = x;
+            else
+                right[g] = x;
+        }
+        pull(p);
+        pull(x);
+    }
+
+    void splay(int x) {
+        path.clear();
+        for (int y{x};; y = up[y]) {
+            path.push_back(y);
+            if (isSplayRoot(y))
+                break;
+        }
+        for (int k{static_cast<int>(path.size()) - 1}; k >= 0; k--)
+            pushDown(path[k]);
+
+        while (!isSplayRoot(x)) {
+            int p{up[x]};
+            if (!isSplayRoot(p))
+                rotate((left[p] == x) == (left[up[p]] == p) ? p : x);
+            rotate(x);
+        }
+    }
+
+    void access(int x) {
+        int last{NIL};
+        for (int y{x}; y != NIL; y = up[y]) {
+            splay(y);
+            right[y] = last;
+            pull(y);
+            last = y;
+        }
+        splay(x);
+    }
+
+    void makeRoot(int x) {
+        access(x);
+        flip[x] = !flip[x];
+    }
+
+    int findRoot(int x) {
+        access(x);
+        pushDown(x);
+        while (left[x] != NIL) {
+            x = left[x];
+            pushDown(x);
+        }
+        splay(x);
+        return x;
+    }
+
+    void cut(int x, int y) {
+        makeRoot(x);
+        access(y);
+        left[y] = NIL;
+        up[x] = NIL;
+        pull(y);
+    }
+};
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+long long forestWeight(const Graph &F) {
+    long long total{0};
+    for (int u{0}; u < F.n(); u++)
+        for (const Edge &e : F.E[u])
+            total += e.w;
+    return total / 2;
+}
+
+// The foreCastLab4 useless-edge graph, built one edge at a time, then a forest edge removed
+void testUselessEdge() {
+    std::cout << "=== Useless edges, inserted one at a time ===\n";
+    DynamicForest F(4);
+    int edges[5][3]{{0, 1, 1}, {1, 2, 2}, {2, 3, 3}, {0, 2, 4}, {1, 3, 5}};
+    int ids[5];
+    for (int j{0}; j < 5; j++) {
+        ids[j] = F.insertEdge(edges[j][0], edges[j][1], edges[j][2]);
+        std::cout << edges[j][0] << " --" << edges[j][2] << "-- " << edges[j][1] << ": " << (F.inForest(ids[j]) ? "safe" : "useless") << "\n";
+    }
+    std::cout << "Forest weight: " << F.weight() << " (expected 6)\n";
+
+    F.deleteEdge(ids[1]);
+    std::cout << "After deleting 1 --2-- 2:";
+    for (const Edge &e : F.forest())
+        std::cout << " " << e.u << "-" << e.v;
+    std::cout << ", weight " << F.weight() << " (expected 0-1, 2-3, 0-2, weight 8)\n";
+}
+
+// Random graph kept under a stream of deletions and insertions; the dynamic forest is checked
+// against Kruskal at the end, and one Kruskal run is the cost of recomputing per update
+void benchmark(int n, int m, int updates) {
+    std::cout << "\n=== " << n << " vertices, " << m << " edges, " << updates << " updates ===\n";
+    std::mt19937 rng(17);
+    DynamicForest F(n);
+    std::vector<int> live;
+    live.reserve(m);
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    for (int j{0}; j < m; j++)
+        live.push_back(F.insertEdge(rng() % n, rng() % n, 1 + rng() % 1000000));
+    std::cout << "Build by insertion: " << elapsedSince(start) << " ms, forest weight " << F.weight() << "\n";
+
+    // Alternate deleting a random live edge with inserting a new one, so m stays the same
+    int deleted{0};
+    start = std::chrono::steady_clock::now();
+    for (int j{0}; j < updates; j++) {
+        if (j % 2 == 0) {
+            int k{static_cast<int>(rng() % live.size())};
+            deleted += F.inForest(live[k]);
+            F.deleteEdge(live[k]);
+            live[k] = live.back();
+            live.pop_back();
+        } else {
+            live.push_back(F.insertEdge(rng() % n, rng() % n, 1 + rng() % 1000000));
+        }
+    }
+    double dynamicTime{elapsedSince(start)};
+    std::cout << "Dynamic forest: " << dynamicTime * 1000 / updates << " us/update (" << deleted << " forest edges deleted)\n";
+
+    Graph G(n);
+    for (const Edge &e : F.graphEdges())
+        G.add_edge(e.u, e.v, e.w);
+    start = std::chrono::steady_clock::now();
+    Graph MST{kruskalMST(G)};
+    double kruskalTime{elapsedSince(start)};
+    std::cout << "Kruskal recomputation: " << kruskalTime << " ms/update\n";
+    std::cout << "Final forest weight " << F.weight() << ", Kruskal " << forestWeight(MST) << (F.weight() == forestWeight(MST) ? " (match)" : " MISMATCH") << "\n";
+}
+
+int main(int argc, char *argv[]) {
+    testUselessEdge();
+
+    int n{argc > 1 ? std::atoi(argv[1]) : 100000};
+    benchmark(n, 4 * n, argc > 2 ? std::atoi(argv[2]) : 1000000);
+}
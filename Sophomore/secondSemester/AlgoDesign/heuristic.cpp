@@ -1,7 +1,14 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <limits>
 #include <queue>
+#include <random>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -15,9 +22,13 @@ struct Node {
     Node(int x = 0, int y = 0, bool walkable = true) : x{x}, y{y}, walkable{walkable} {}
 };
 
+// Open set entries keep the f they were pushed with; changing f on a node already in the
+// heap would break the heap order
+typedef std::pair<double, Node *> OpenEntry;
+
 struct CompareNode {
-    bool operator()(const Node *a, const Node *b) {
-        return a->f > b->f;
+    bool operator()(const OpenEntry &a, const OpenEntry &b) {
+        return a.first > b.first;
     }
 };
 
@@ -26,17 +37,22 @@ double heuristic(const Node &a, const Node &b) {
 }
 
 std::vector<Node *> aStar(Node *start, Node *goal, std::vector<std::vector<Node>> &grid) {
-    std::priority_queue<Node *, std::vector<Node *>, CompareNode> openSet{};
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, CompareNode> openSet{};
     std::unordered_map<Node *, bool> closedSet{};
 
     start->g = 0;
     start->f = heuristic(*start, *goal);
-    openSet.push(start);
+    openSet.push({start->f, start});
 
     while (!openSet.empty()) {
-        Node *current = openSet.top();
+        Node *current = openSet.top().second;
         openSet.pop();
 
+        // Stale entry of a node that was reached again more cheaply
+        if (closedSet.count(current)) {
+            continue;
+        }
+
         if (current == goal) {
             std::vector<Node *> path{};
             while (current != nullptr) {
@@ -72,7 +88,7 @@ std::vector<Node *> aStar(Node *start, Node *goal, std::vector<std::vector<Node>
                 neighbor->parent = current;
                 neighbor->g = tentative_g;
                 neighbor->f = neighbor->g + heuristic(*neighbor, *goal);
-                openSet.push(neighbor);
+                openSet.push({neighbor->f, neighbor});
             }
         }
     }
@@ -80,7 +96,595 @@ std::vector<Node *> aStar(Node *start, Node *goal, std::vector<std::vector<Node>
     return {};
 }
 
-int main(void) {
+// Static map shared by every search: a flat byte array with a border of blocked cells, so
+// neighbours never need a bounds check. It is never written after construction, so any
+// number of threads can search it at once.
+class GridMap {
+  public:
+    // walkable[x * height + y] tells whether cell (x, y) is open
+    GridMap(int width, int height, const std::vector<char> &walkable)
+        : width(width), height(height), stride(height + 2), open(static_cast<size_t>(width + 2) * (height + 2), 0) {
+        for (int x = 0; x < width; x++) {
+            for (int y = 0; y < height; y++) {
+                open[cell(x, y)] = walkable[static_cast<size_t>(x) * height + y];
+            }
+        }
+    }
+
+    explicit GridMap(const std::vector<std::vector<Node>> &grid)
+        : width(grid.size()), height(grid.empty() ? 0 : grid[0].size()), stride(height + 2), open(static_cast<size_t>(width + 2) * (height + 2), 0) {
+        for (int x = 0; x < width; x++) {
+            for (int y = 0; y < height; y++) {
+                open[cell(x, y)] = grid[x][y].walkable;
+            }
+        }
+    }
+
+    bool contains(int x, int y) const {
+        return x >= 0 && x < width && y >= 0 && y < height;
+    }
+
+    int cell(int x, int y) const {
+        return (x + 1) * stride + y + 1;
+    }
+
+    int cellX(int c) const {
+        return c / stride - 1;
+    }
+
+    int cellY(int c) const {
+        return c % stride - 1;
+    }
+
+    // Distance between horizontally adjacent cells
+    int rowStride() const {
+        return stride;
+    }
+
+    // Cells including the border
+    size_t cellCount() const {
+        return open.size();
+    }
+
+    const char *cells() const {
+        return open.data();
+    }
+
+  private:
+    int width, height, stride;
+    std::vector<char> open;
+};
+
+// One search worker over a GridMap. The open set is a binary heap indexed by cell, so an
+// improved cell moves up in place instead of being pushed again. Heap entries carry their
+// own f and g, so ordering them never reads the per-cell state. Costs are integers in
+// units of STRAIGHT, held in 64 bits because a path through a maze can be millions of steps
+// long. The per-cell scratch state is owned by the worker and reused: a cell's entry only
+// counts when its stamp equals the current generation, so starting a query is one
+// increment rather than a pass over the touched cells.
+//
+// Diagonal moves may not cut corners: both orthogonal neighbours must be open. Jump Point
+// Search expands only jump points. From a node it follows the directions its parent
+// direction leaves open (natural plus forced neighbours) until the line hits a cell with a
+// forced neighbour, the goal, or a wall. On 8-connected maps a diagonal line stops where
+// one of its straight scans finds a jump point. On 4-connected maps horizontal moves play
+// the diagonal role: vertical scans leave every step of a horizontal line, and a vertical
+// line only turns where a wall beside it ends.
+class GridPathfinder {
+  public:
+    enum Mode { ASTAR4, ASTAR8, JPS4, JPS8 };
+
+    static constexpr int STRAIGHT = 1000;
+    static constexpr int DIAGONAL = 1414;
+
+    explicit GridPathfinder(const GridMap &map) : map(map), open(map.cells()), stride(map.rowStride()), state(map.cellCount()) {}
+
+    // Cost of a shortest path in units of STRAIGHT, -1 if there is none; path receives
+    // every cell from start to goal
+    int64_t findPath(int sx, int sy, int gx, int gy, Mode mode, std::vector<std::pair<int, int>> &path) {
+        path.clear();
+        expandedCount = 0;
+        if (!map.contains(sx, sy) || !map.contains(gx, gy)) {
+            return -1;
+        }
+        int start = cell(sx, sy);
+        goal = cell(gx, gy);
+        goalX = gx;
+        goalY = gy;
+        diagonal = mode == ASTAR8 || mode == JPS8;
+        if (!open[start] || !open[goal]) {
+            return -1;
+        }
+
+        // Every entry stamped by earlier queries becomes stale at once
+        heap.clear();
+        if (++generation == 0) {
+            for (CellState &entry : state) {
+                entry.stamp = 0;
+            }
+            generation = 1;
+        }
+
+        visit(start);
+        state[start].g = 0;
+        push(start, estimate(start));
+        int64_t cost = -1;
+        while (!heap.empty()) {
+            int current = pop();
+            state[current].heapIndex = CLOSED;
+            expandedCount++;
+            if (current == goal) {
+                cost = state[goal].g;
+                break;
+            }
+
+            if (mode == ASTAR4 || mode == ASTAR8) {
+                expandNeighbours(current);
+            } else {
+                expandJumpPoints(current, mode == JPS8);
+            }
+        }
+
+        if (cost >= 0) {
+            buildPath(path);
+        }
+        return cost;
+    }
+
+    // Nodes taken off the open set by the last query
+    int expanded() const {
+        return expandedCount;
+    }
+
+  private:
+    // heapIndex of a cell that has left the open set for good
+    static constexpr int CLOSED = -2;
+
+    // Search state of one cell. f is only needed while the cell is open, so it lives in the
+    // heap entry; the rest is packed to 4-byte alignment, 20 bytes per cell instead of 24.
+    struct __attribute__((packed, aligned(4))) CellState {
+        int64_t g = 0;
+        uint32_t stamp = 0;
+        int parent = -1;
+        int heapIndex = -1;
+    };
+    static_assert(sizeof(CellState) == 20, "scratch state is 20 bytes per cell");
+
+    struct HeapEntry {
+        int64_t f;
+        int64_t g;
+        int cell;
+    };
+
+    const GridMap &map;
+    const char *open;
+    int stride;
+    std::vector<CellState> state;
+    std::vector<HeapEntry> heap;
+    uint32_t generation = 0;
+    int goal = 0, goalX = 0, goalY = 0;
+    bool diagonal = false;
+    int expandedCount = 0;
+
+    int cell(int x, int y) const {
+        return map.cell(x, y);
+    }
+
+    int cellX(int c) const {
+        return map.cellX(c);
+    }
+
+    int cellY(int c) const {
+        return map.cellY(c);
+    }
+
+    // Claims a cell's entry for this query, clearing what an earlier query left there
+    void visit(int c) {
+        if (state[c].stamp != generation) {
+            state[c].stamp = generation;
+            state[c].g = INT64_MAX;
+            state[c].parent = -1;
+            state[c].heapIndex = -1;
+        }
+    }
+
+    // Octile distance on 8-connected maps, Manhattan distance on 4-connected ones
+    int64_t estimate(int c) const {
+        int64_t dx = std::abs(cellX(c) - goalX);
+        int64_t dy = std::abs(cellY(c) - goalY);
+        return diagonal ? STRAIGHT * (dx + dy) + (DIAGONAL - 2 * STRAIGHT) * std::min(dx, dy) : STRAIGHT * (dx + dy);
+    }
+
+    // Lower f first; among equal f the deeper node, which heads straight for the goal
+    static bool before(const HeapEntry &a, const HeapEntry &b) {
+        return a.f < b.f || (a.f == b.f && a.g > b.g);
+    }
+
+    void siftUp(int i) {
+        HeapEntry c = heap[i];
+        while (i > 0 && before(c, heap[(i - 1) / 2])) {
+            heap[i] = heap[(i - 1) / 2];
+            state[heap[i].cell].heapIndex = i;
+            i = (i - 1) / 2;
+        }
+        heap[i] = c;
+        state[c.cell].heapIndex = i;
+    }
+
+    void push(int c, int64_t f) {
+        heap.push_back({f, state[c].g, c});
+        siftUp(heap.size() - 1);
+    }
+
+    int pop() {
+        int top = heap[0].cell;
+        HeapEntry last = heap.back();
+        heap.pop_back();
+        state[top].heapIndex = -1;
+        if (!heap.empty()) {
+            int i = 0;
+            int n = heap.size();
+            while (true) {
+                int child = 2 * i + 1;
+                if (child >= n) {
+                    break;
+                }
+                if (child + 1 < n && before(heap[child + 1], heap[child])) {
+                    child++;
+                }
+                if (!before(heap[child], last)) {
+                    break;
+                }
+                heap[i] = heap[child];
+                state[heap[i].cell].heapIndex = i;
+                i = child;
+            }
+            heap[i] = last;
+            state[last.cell].heapIndex = i;
+        }
+        return top;
+    }
+
+    void relax(int from, int to, int64_t cost) {
+        visit(to);
+        CellState &entry = state[to];
+        if (entry.heapIndex == CLOSED || state[from].g + cost >= entry.g) {
+            return;
+        }
+        entry.g = state[from].g + cost;
+        entry.parent = from;
+        if (entry.heapIndex == -1) {
+            push(to, entry.g + estimate(to));
+        } else {
+            heap[entry.heapIndex] = {entry.g + estimate(to), entry.g, to};
+            siftUp(entry.heapIndex);
+        }
+    }
+
+    void expandNeighbours(int c) {
+        const int straight[4] = {stride, -stride, 1, -1};
+        for (int d : straight) {
+            if (open[c + d]) {
+                relax(c, c + d, STRAIGHT);
+            }
+        }
+        if (diagonal) {
+            for (int dx : {-stride, stride}) {
+                for (int dy : {-1, 1}) {
+                    if (open[c + dx] && open[c + dy] && open[c + dx + dy]) {
+                        relax(c, c + dx + dy, DIAGONAL);
+                    }
+                }
+            }
+        }
+    }
+
+    // Straight line on an 8-connected map; stops where a wall beside the line ends
+    int jumpStraight8(int c, int d, int side) const {
+        while (true) {
+            c += d;
+            if (!open[c]) {
+                return -1;
+            }
+            if (c == goal || (open[c + side] && !open[c - d + side]) || (open[c - side] && !open[c - d - side])) {
+                return c;
+            }
+        }
+    }
+
+    int jumpDiagonal8(int c, int dx, int dy) const {
+        while (true) {
+            c += dx + dy;
+            if (!open[c]) {
+                return -1;
+            }
+            if (c == goal || jumpStraight8(c, dx, 1) != -1 || jumpStraight8(c, dy, stride) != -1) {
+                return c;
+            }
+            if (!open[c + dx] || !open[c + dy]) {
+                return -1;
+            }
+        }
+    }
+
+    int jumpVertical4(int c, int dy) const {
+        while (true) {
+            c += dy;
+            if (!open[c]) {
+                return -1;
+            }
+            if (c == goal || (open[c + stride] && !open[c - dy + stride]) || (open[c - stride] && !open[c - dy - stride])) {
+                return c;
+            }
+        }
+    }
+
+    int jumpHorizontal4(int c, int dx) const {
+        while (true) {
+            c += dx;
+            if (!open[c]) {
+                return -1;
+            }
+            if (c == goal || jumpVertical4(c, 1) != -1 || jumpVertical4(c, -1) != -1) {
+                return c;
+            }
+        }
+    }
+
+    // Follows one direction from c and relaxes the jump point it reaches, if any. dx is
+    // a multiple of stride (-stride, 0, stride) and dy one of -1, 0, 1.
+    void jumpFrom(int c, int dx, int dy, bool eight) {
+        int target;
+        if (eight) {
+            target = dx != 0 && dy != 0 ? jumpDiagonal8(c, dx, dy) : jumpStraight8(c, dx + dy, dx != 0 ? 1 : stride);
+        } else {
+            target = dx != 0 ? jumpHorizontal4(c, dx) : jumpVertical4(c, dy);
+        }
+        if (target == -1) {
+            return;
+        }
+
+        int64_t steps = std::max(std::abs(cellX(target) - cellX(c)), std::abs(cellY(target) - cellY(c)));
+        relax(c, target, steps * (dx != 0 && dy != 0 ? DIAGONAL : STRAIGHT));
+    }
+
+    void expandJumpPoints(int c, bool eight) {
+        int p = state[c].parent;
+        if (p == -1) {
+            for (int dx : {-stride, 0, stride}) {
+                for (int dy : {-1, 0, 1}) {
+                    if ((dx == 0 && dy == 0) || (!eight && dx != 0 && dy != 0)) {
+                        continue;
+                    }
+                    if (dx == 0 || dy == 0 || (open[c + dx] && open[c + dy])) {
+                        jumpFrom(c, dx, dy, eight);
+                    }
+                }
+            }
+            return;
+        }
+
+        // Direction of travel from the parent jump point
+        int dx = cellX(c) > cellX(p) ? stride : cellX(c) < cellX(p) ? -stride : 0;
+        int dy = cellY(c) > cellY(p) ? 1 : cellY(c) < cellY(p) ? -1 : 0;
+
+        if (!eight) {
+            if (dx != 0) {
+                jumpFrom(c, dx, 0, false);
+                jumpFrom(c, 0, 1, false);
+                jumpFrom(c, 0, -1, false);
+            } else {
+                jumpFrom(c, 0, dy, false);
+                for (int side : {-stride, stride}) {
+                    if (open[c + side] && !open[c - dy + side]) {
+                        jumpFrom(c, side, 0, false);
+                    }
+                }
+            }
+            return;
+        }
+
+        if (dx != 0 && dy != 0) {
+            if (open[c + dy]) {
+                jumpFrom(c, 0, dy, true);
+            }
+            if (open[c + dx]) {
+                jumpFrom(c, dx, 0, true);
+            }
+            if (open[c + dx] && open[c + dy]) {
+                jumpFrom(c, dx, dy, true);
+            }
+            return;
+        }
+
+        // Straight travel: straight on, and both sides with the diagonals between
+        int d = dx + dy;
+        int sides[2] = {dx != 0 ? 1 : stride, dx != 0 ? -1 : -stride};
+        if (open[c + d]) {
+            jumpFrom(c, dx, dy, true);
+        }
+        for (int side : sides) {
+            if (!open[c + side]) {
+                continue;
+            }
+            jumpFrom(c, dx != 0 ? 0 : side, dx != 0 ? side : 0, true);
+            if (open[c + d]) {
+                jumpFrom(c, dx != 0 ? dx : side, dx != 0 ? side : dy, true);
+            }
+        }
+    }
+
+    // Walks back over the jump points and fills in the cells between them
+    void buildPath(std::vector<std::pair<int, int>> &path) const {
+        for (int c = goal; c != -1; c = state[c].parent) {
+            int p = state[c].parent;
+            int x = cellX(c);
+            int y = cellY(c);
+            path.push_back({x, y});
+            if (p == -1) {
+                break;
+            }
+
+            int px = cellX(p);
+            int py = cellY(p);
+            int sx = (px > x) - (px < x);
+            int sy = (py > y) - (py < y);
+            for (x += sx, y += sy; x != px || y != py; x += sx, y += sy) {
+                path.push_back({x, y});
+            }
+        }
+        std::reverse(path.begin(), path.end());
+    }
+};
+
+struct PathRequest {
+    int sx, sy; // Start
+    int gx, gy; // Goal
+};
+
+struct PathResult {
+    int64_t cost = -1; // In units of GridPathfinder::STRAIGHT, -1 if unreachable
+    int expanded = 0;
+    std::vector<std::pair<int, int>> path{};
+};
+
+// Answers batches of path queries on one shared map. Each worker keeps its own
+// GridPathfinder, so scratch memory (about 20 bytes per cell per worker) is allocated once
+// and reused by every later batch. Workers take the next unanswered request from a shared
+// counter, because query costs vary too much for fixed slices to balance.
+class PathService {
+  public:
+    PathService(const GridMap &map, int workers) {
+        for (int i = 0; i < std::max(1, workers); i++) {
+            finders.emplace_back(map);
+        }
+    }
+
+    // results[i] answers requests[i]
+    void solveBatch(const std::vector<PathRequest> &requests, GridPathfinder::Mode mode, std::vector<PathResult> &results) {
+        results.resize(requests.size());
+        std::atomic<size_t> next{0};
+        auto work = [&](GridPathfinder &finder) {
+            for (size_t i = next++; i < requests.size(); i = next++) {
+                const PathRequest &request = requests[i];
+                results[i].cost = finder.findPath(request.sx, request.sy, request.gx, request.gy, mode, results[i].path);
+                results[i].expanded = finder.expanded();
+            }
+        };
+
+        if (finders.size() == 1) {
+            work(finders[0]);
+            return;
+        }
+        std::vector<std::thread> pool{};
+        for (GridPathfinder &finder : finders) {
+            pool.emplace_back(work, std::ref(finder));
+        }
+        for (std::thread &t : pool) {
+            t.join();
+        }
+    }
+
+    int workers() const {
+        return finders.size();
+    }
+
+  private:
+    std::vector<GridPathfinder> finders{};
+};
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Random obstacles on a side x side map; A* and JPS must agree on every cost, and the
+// original aStar is run on the first few queries as the baseline for 4-connected moves
+void benchmark(int side, int obstaclePercent, int queries) {
+    std::mt19937 rng(49);
+    std::vector<char> walkable(static_cast<size_t>(side) * side);
+    for (char &cell : walkable) {
+        cell = static_cast<int>(rng() % 100) >= obstaclePercent;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    GridMap map(side, side, walkable);
+    GridPathfinder finder(map);
+    std::cout << side << "x" << side << " map, " << obstaclePercent << "% obstacles, built in " << elapsedSince(start) << " ms\n";
+
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> pairs{};
+    while (static_cast<int>(pairs.size()) < queries) {
+        int sx = rng() % side, sy = rng() % side, gx = rng() % side, gy = rng() % side;
+        if (walkable[static_cast<size_t>(sx) * side + sy] && walkable[static_cast<size_t>(gx) * side + gy]) {
+            pairs.push_back({{sx, sy}, {gx, gy}});
+        }
+    }
+
+    const char *names[4] = {"A* 4-connected", "A* 8-connected", "JPS 4-connected", "JPS 8-connected"};
+    std::vector<std::vector<int64_t>> costs(4, std::vector<int64_t>(queries));
+    std::vector<std::pair<int, int>> path{};
+    for (int mode = 0; mode < 4; mode++) {
+        long long expanded = 0;
+        start = std::chrono::steady_clock::now();
+        for (int q = 0; q < queries; q++) {
+            costs[mode][q] = finder.findPath(pairs[q].first.first, pairs[q].first.second, pairs[q].second.first, pairs[q].second.second,
+                                             static_cast<GridPathfinder::Mode>(mode), path);
+            expanded += finder.expanded();
+        }
+        double time = elapsedSince(start);
+        std::cout << names[mode] << ": " << time / queries << " ms/query, " << expanded / queries << " expanded/query\n";
+    }
+
+    int mismatches = 0;
+    for (int q = 0; q < queries; q++) {
+        mismatches += costs[0][q] != costs[2][q];
+        mismatches += costs[1][q] != costs[3][q];
+    }
+    std::cout << "Cost mismatches between A* and JPS: " << mismatches << "\n";
+
+    // The same JPS queries as one batch on every hardware thread
+    std::vector<PathRequest> batch{};
+    for (const std::pair<std::pair<int, int>, std::pair<int, int>> &pair : pairs) {
+        batch.push_back({pair.first.first, pair.first.second, pair.second.first, pair.second.second});
+    }
+    PathService service(map, std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<PathResult> results{};
+    for (int round = 0; round < 2; round++) {
+        start = std::chrono::steady_clock::now();
+        service.solveBatch(batch, GridPathfinder::JPS8, results);
+        double time = elapsedSince(start);
+        std::cout << "Service batch " << round + 1 << " (" << service.workers() << " workers): " << time / queries << " ms/query\n";
+    }
+    for (int q = 0; q < queries; q++) {
+        mismatches += results[q].cost != costs[3][q];
+    }
+
+    // The original implementation needs a Node per cell and a full reset between queries
+    int baselineQueries = std::min(queries, 3);
+    std::vector<std::vector<Node>> grid(side, std::vector<Node>(side));
+    for (int x = 0; x < side; x++) {
+        for (int y = 0; y < side; y++) {
+            grid[x][y] = Node{x, y, walkable[static_cast<size_t>(x) * side + y] != 0};
+        }
+    }
+    double baselineTime = 0;
+    for (int q = 0; q < baselineQueries; q++) {
+        for (std::vector<Node> &column : grid) {
+            for (Node &node : column) {
+                node.g = node.f = std::numeric_limits<double>::infinity();
+                node.parent = nullptr;
+            }
+        }
+        start = std::chrono::steady_clock::now();
+        std::vector<Node *> found = aStar(&grid[pairs[q].first.first][pairs[q].first.second], &grid[pairs[q].second.first][pairs[q].second.second], grid);
+        baselineTime += elapsedSince(start);
+        int64_t cost = found.empty() ? -1 : (static_cast<int64_t>(found.size()) - 1) * GridPathfinder::STRAIGHT;
+        mismatches += cost != costs[0][q];
+    }
+    std::cout << "Original aStar: " << baselineTime / baselineQueries << " ms/query over " << baselineQueries << " queries, "
+              << "mismatches so far: " << mismatches << "\n";
+}
+
+void demo() {
     std::vector<std::vector<Node>> grid(5, std::vector<Node>(5));
     for (int i = 0; i < 5; ++i) {
         for (int j = 0; j < 5; ++j) {
@@ -103,3 +707,11 @@ int main(void) {
     }
     std::cout << "\n";
 }
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        benchmark(std::atoi(argv[1]), argc > 2 ? std::atoi(argv[2]) : 20, argc > 3 ? std::atoi(argv[3]) : 20);
+        return 0;
+    }
+    demo();
+}
@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef int WeightType;
+
+// Graph representation, copied from foreCastLab4.cpp
+struct Edge {
+    int u, v;
+    WeightType w;
+    bool operator>(const Edge &other) const { return w > other.w; }
+};
+
+struct Graph {
+    Graph(int n) : E(n) {}
+    std::vector<std::list<Edge>> E;
+
+    void add_edge(int u, int v, WeightType w) {
+        E[u].push_back({u, v, w});
+        E[v].push_back({v, u, w});
+    }
+
+    int n() const { return E.size(); }
+
+    int m() const {
+        int res{0};
+        for (const std::list<Edge> &list : E)
+            res += list.size();
+        return res / 2;
+    }
+};
+
+// Point-to-point shortest path queries on an undirected graph with non-negative weights.
+// The graph is flattened once into offset/target/weight arrays. Per-query state is stamped
+// with a query number, so a query only pays for the vertices it touches.
+//
+// ALT preprocessing picks landmarks by farthest-point selection and stores, for every vertex,
+// its distance to each landmark in one compact int array (vertex-major, so one lookup reads
+// one cache line). By the triangle inequality |D(l, v) - D(l, t)| <= d(v, t) for every
+// landmark l, which gives A* an admissible and consistent estimate.
+class PointToPoint {
+  public:
+    static constexpr long long UNREACHABLE{-1};
+
+    explicit PointToPoint(const Graph &G) : n(G.n()), offset(G.n() + 1, 0), landmarks(0), stamp(0), settled(0) {
+        for (int u{0}; u < n; u++)
+            offset[u + 1] = offset[u] + G.E[u].size();
+
+        target.resize(offset[n]);
+        weight.resize(offset[n]);
+        for (int u{0}; u < n; u++) {
+            int a{offset[u]};
+            for (const Edge &e : G.E[u]) {
+                target[a] = e.v;
+                weight[a] = e.w;
+                a++;
+            }
+        }
+
+        for (int side{0}; side < 2; side++) {
+            dist[side].resize(n);
+            seen[side].assign(n, 0);
+            done[side].assign(n, 0);
+        }
+    }
+
+    // Farthest-point selection: each new landmark is the vertex farthest from all landmarks so far
+    void buildLandmarks(int count, unsigned seed = 1) {
+        landmarks = count;
+        landmarkDist.assign(static_cast<size_t>(n) * count, INT_MAX);
+        if (n == 0)
+            return;
+
+        std::vector<int> d;
+        std::vector<int> nearest(n, INT_MAX);
+        std::mt19937 rng(seed);
+
+        singleSource(rng() % n, d);
+        int next{static_cast<int>(std::max_element(d.begin(), d.end(), [](int a, int b) {
+                                      return (a == INT_MAX ? -1 : a) < (b == INT_MAX ? -1 : b);
+                                  }) -
+                                  d.begin())};
+
+        for (int l{0}; l < count; l++) {
+            singleSource(next, d);
+            for (int v{0}; v < n; v++) {
+                landmarkDist[static_cast<size_t>(v) * count + l] = d[v];
+                nearest[v] = std::min(nearest[v], d[v]);
+            }
+
+            for (int v{0}; v < n; v++) {
+                if (nearest[v] != INT_MAX && (nearest[next] == INT_MAX || nearest[v] > nearest[next]))
+                    next = v;
+            }
+        }
+    }
+
+    int landmarkCount() const { return landmarks; }
+
+    // Vertices the last query took off its queue(s)
+    int settledCount() const { return settled; }
+
+    // Plain Dijkstra from s, stopping as soon as t is settled
+    long long dijkstra(int s, int t) {
+        return unidirectional(s, t, false);
+    }
+
+    // A* with the landmark bound as estimate
+    long long astar(int s, int t) {
+        return unidirectional(s, t, true);
+    }
+
+    // Searches from s and from t at once, always growing the side with the smaller key. Every
+    // edge that connects the two searches offers a candidate mu. Once the two queue minima
+    // add up to mu nothing shorter can appear. With landmarks both searches use the average
+    // potential p(v) = (pi_t(v) - pi_s(v)) / 2 (forward) and -p(v) (backward), which keeps
+    // the same stopping rule valid. Keys are doubled to stay in integers.
+    long long bidirectional(int s, int t, bool useLandmarks) {
+        newQuery();
+        if (s == t)
+            return 0;
+
+        std::function<long long(int)> potential{[&](int v) -> long long {
+            return useLandmarks ? lowerBound(v, t) - lowerBound(v, s) : 0;
+        }};
+
+        Heap heap[2];
+        touch(0, s, 0);
+        touch(1, t, 0);
+        heap[0].push({potential(s), s});
+        heap[1].push({-potential(t), t});
+
+        long long best{LLONG_MAX};
+        while (!heap[0].empty() && !heap[1].empty()) {
+            if (best != LLONG_MAX && heap[0].top().first + heap[1].top().first >= 2 * best)
+                break;
+
+            int side{heap[0].top().first <= heap[1].top().first ? 0 : 1};
+            int u{heap[side].top().second};
+            heap[side].pop();
+            if (done[side][u] == stamp)
+                continue;
+            done[side][u] = stamp;
+            settled++;
+
+            for (int a{offset[u]}; a < offset[u + 1]; a++) {
+                int v{target[a]};
+                long long candidate{dist[side][u] + weight[a]};
+                if (seen[side][v] != stamp || candidate < dist[side][v]) {
+                    touch(side, v, candidate);
+                    heap[side].push({2 * candidate + (side == 0 ? potential(v) : -potential(v)), v});
+                }
+                if (seen[1 - side][v] == stamp)
+                    best = std::min(best, candidate + dist[1 - side][v]);
+            }
+        }
+        return best == LLONG_MAX ? UNREACHABLE : best;
+    }
+
+  private:
+    typedef std::priority_queue<std::pair<long long, int>, std::vector<std::pair<long long, int>>, std::greater<std::pair<long long, int>>> Heap;
+
+    int n;
+    std::vector<int> offset;
+    std::vector<int> target;
+    std::vector<WeightType> weight;
+
+    int landmarks;
+    std::vector<int> landmarkDist;
+
+    std::vector<long long> dist[2];
+    std::vector<unsigned> seen[2];
+    std::vector<unsigned> done[2];
+    unsigned stamp;
+    int settled;
+
+    void newQuery() {
+        settled = 0;
+        if (++stamp == 0) {
+            for (int side{0}; side < 2; side++) {
+                std::fill(seen[side].begin(), seen[side].end(), 0);
+                std::fill(done[side].begin(), done[side].end(), 0);
+            }
+            stamp = 1;
+        }
+    }
+
+    void touch(int side, int v, long long d) {
+        seen[side][v] = stamp;
+        dist[side][v] = d;
+    }
+
+    // Largest landmark bound on d(u, v), 0 without landmarks
+    long long lowerBound(int u, int v) const {
+        const int *du{landmarkDist.data() + static_cast<size_t>(u) * landmarks};
+        const int *dv{landmarkDist.data() + static_cast<size_t>(v) * landmarks};
+        long long bound{0};
+        for (int l{0}; l < landmarks; l++) {
+            if (du[l] != INT_MAX && dv[l] != INT_MAX)
+                bound = std::max(bound, std::abs(static_cast<long long>(du[l]) - dv[l]));
+        }
+        return bound;
+    }
+
+    long long unidirectional(int s, int t, bool useLandmarks) {
+        newQuery();
+        Heap heap;
+        touch(0, s, 0);
+        heap.push({useLandmarks ? lowerBound(s, t) : 0, s});
+
+        while (!heap.empty()) {
+            int u{heap.top().second};
+            heap.pop();
+            if (done[0][u] == stamp)
+                continue;
+            done[0][u] = stamp;
+            settled++;
+            if (u == t)
+                return dist[0][t];
+
+            for (int a{offset[u]}; a < offset[u + 1]; a++) {
+                int v{target[a]};
+                long long candidate{dist[0][u] + weight[a]};
+                if (seen[0][v] != stamp || candidate < dist[0][v]) {
+                    touch(0, v, candidate);
+                    heap.push({candidate + (useLandmarks ? lowerBound(v, t) : 0), v});
+                }
+            }
+        }
+        return UNREACHABLE;
+    }
+
+    // Full Dijkstra for landmark preprocessing, INT_MAX for unreachable vertices
+    void singleSource(int s, std::vector<int> &d) {
+        d.assign(n, INT_MAX);
+        Heap heap;
+        d[s] = 0;
+        heap.push({0, s});
+        while (!heap.empty()) {
+            std::pair<long long, int> top{heap.top()};
+            heap.pop();
+            if (top.first != d[top.second])
+                continue;
+
+            for (int a{offset[top.second]}; a < offset[top.second + 1]; a++) {
+                if (top.first + weight[a] < d[target[a]]) {
+                    d[target[a]] = top.first + weight[a];
+                    heap.push({d[target[a]], target[a]});
+                }
+            }
+        }
+    }
+};
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void testSmall() {
+    std::cout << "=== Path cost on the foreCastLab4 test tree ===\n";
+    Graph T(5);
+    T.add_edge(0, 1, 2);
+    T.add_edge(0, 2, 3);
+    T.add_edge(1, 3, 1);
+    T.add_edge(1, 4, 5);
+
+    PointToPoint engine(T);
+    engine.buildLandmarks(2);
+    std::cout << "Dijkstra 0 -> 4: " << engine.dijkstra(0, 4) << "\n";
+    std::cout << "Bidirectional 0 -> 4: " << engine.bidirectional(0, 4, false) << "\n";
+    std::cout << "Bidirectional ALT 0 -> 4: " << engine.bidirectional(0, 4, true) << "\n";
+    std::cout << "Expected cost: 7 (0-1-2 + 1-4-5)\n";
+}
+
+// Runs the same random queries through every method and checks they agree
+void benchmark(const std::string &name, const Graph &G, int queries) {
+    std::cout << "\n=== " << name << ": " << G.n() << " vertices, " << G.m() << " edges ===\n";
+    PointToPoint engine(G);
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    engine.buildLandmarks(16);
+    std::cout << "16 landmarks: " << elapsedSince(start) << " ms\n";
+
+    std::mt19937 rng(11);
+    std::vector<std::pair<int, int>> pairs(queries);
+    for (std::pair<int, int> &p : pairs)
+        p = {static_cast<int>(rng() % G.n()), static_cast<int>(rng() % G.n())};
+
+    std::vector<long long> expected;
+    const char *names[4]{"Dijkstra", "Bidirectional", "A* (ALT)", "Bidirectional ALT"};
+    for (int method{0}; method < 4; method++) {
+        long long settledTotal{0};
+        bool agree{true};
+        start = std::chrono::steady_clock::now();
+        for (int q{0}; q < queries; q++) {
+            int s{pairs[q].first};
+            int t{pairs[q].second};
+            long long d{method == 0 ? engine.dijkstra(s, t) : method == 1 ? engine.bidirectional(s, t, false) : method == 2 ? engine.astar(s, t) : engine.bidirectional(s, t, true)};
+            settledTotal += engine.settledCount();
+            if (method == 0)
+                expected.push_back(d);
+            else
+                agree = agree && d == expected[q];
+        }
+        double elapsed{elapsedSince(start)};
+        std::cout << names[method] << ": " << elapsed / queries << " ms/query, " << settledTotal / queries << " settled/query" << (agree ? "" : " MISMATCH") << "\n";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testSmall();
+
+    int side{argc > 1 ? std::atoi(argv[1]) : 500};
+    std::mt19937 rng(5);
+
+    // Grid road network with random travel times
+    Graph grid(side * side);
+    for (int r{0}; r < side; r++) {
+        for (int c{0}; c < side; c++) {
+            int v{r * side + c};
+            if (c + 1 < side)
+                grid.add_edge(v, v + 1, 1 + rng() % 100);
+            if (r + 1 < side)
+                grid.add_edge(v, v + side, 1 + rng() % 100);
+        }
+    }
+    benchmark("Grid", grid, 100);
+
+    // Sparse random graph with average degree 4
+    int n{side * side};
+    Graph sparse(n);
+    for (int j{0}; j < 2 * n; j++)
+        sparse.add_edge(rng() % n, rng() % n, 1 + rng() % 100);
+    benchmark("Random", sparse, 100);
+}
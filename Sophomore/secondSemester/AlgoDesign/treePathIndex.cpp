@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <queue>
+#include <random>
+#include <stack>
+#include <thread>
+#include <vector>
+
+typedef int WeightType;
+
+// Graph representation, primForest and pathCost, copied from foreCastLab4.cpp
+struct Edge {
+    int u, v;
+    WeightType w;
+    bool operator>(const Edge &other) const { return w > other.w; }
+};
+
+struct Graph {
+    Graph(int n) : E(n) {}
+    std::vector<std::list<Edge>> E;
+
+    void add_edge(int u, int v, WeightType w) {
+        E[u].push_back({u, v, w});
+        E[v].push_back({v, u, w});
+    }
+
+    int n() const { return E.size(); }
+
+    int m() const {
+        int res{0};
+        for (const std::list<Edge> &list : E)
+            res += list.size();
+        return res / 2;
+    }
+};
+
+std::pair<Graph, int> primForest(const Graph &G) {
+    std::priority_queue<Edge, std::vector<Edge>, std::greater<Edge>> pq;
+    Graph MST(G.n());
+    std::vector<bool> visited(G.n(), false);
+    int tree_count{0};
+
+    for (int start{0}; start < G.n(); ++start) {
+        if (!visited[start]) {
+            tree_count++;
+            visited[start] = true;
+
+            for (const Edge &e : G.E[start])
+                pq.push(e);
+
+            while (!pq.empty()) {
+                Edge e{pq.top()};
+                pq.pop();
+
+                if (visited[e.u] && visited[e.v])
+                    continue;
+
+                int new_vertex{visited[e.u] ? e.v : e.u};
+                visited[new_vertex] = true;
+                MST.add_edge(e.u, e.v, e.w);
+
+                for (const Edge &edge : G.E[new_vertex]) {
+                    if (!visited[edge.v])
+                        pq.push(edge);
+                }
+            }
+        }
+    }
+
+    return {MST, tree_count};
+}
+
+WeightType pathCost(const Graph &T, int root, int target) {
+    std::vector<WeightType> dist(T.n(), -1);
+    std::vector<int> parent(T.n(), -1);
+    std::stack<int> s;
+
+    dist[root] = 0;
+    s.push(root);
+
+    while (!s.empty()) {
+        int u{s.top()};
+        s.pop();
+
+        for (const Edge &e : T.E[u]) {
+            if (e.v != parent[u]) {
+                parent[e.v] = u;
+                dist[e.v] = dist[u] + e.w;
+                if (e.v == target) return dist[target];
+                s.push(e.v);
+            }
+        }
+    }
+
+    return -1; // Not reachable
+}
+
+// Runs f(lo, hi) on `threads` contiguous slices of [0, n), inline when threads is 1
+template <class F>
+void parallelFor(int n, int threads, F f) {
+    if (threads <= 1) {
+        f(0, n);
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    int chunk{(n + threads - 1) / threads};
+    for (int lo{0}; lo < n; lo += chunk)
+        pool.emplace_back(f, lo, std::min(n, lo + chunk));
+    for (std::thread &t : pool)
+        t.join();
+}
+
+// Bits needed to write x, 0 for 0: floor(log2(x)) + 1
+int bitWidth(unsigned x) {
+    return x == 0 ? 0 : 32 - __builtin_clz(x);
+}
+
+// Path queries on a tree or forest, such as a spanning tree from primForest, after one
+// O(n log n) preprocessing pass.
+//
+// Path cost is D(u) + D(v) - 2 D(lca) with D the distance from the tree root. The LCA comes
+// from a sparse table over the DFS preorder: for tin[u] < tin[v] it is the parent of the
+// shallowest vertex at preorder positions (tin[u], tin[v]], and that parent is also the
+// one with the smallest preorder number, so the table keeps plain minima of tin[parent].
+// That answers in O(1). The heaviest edge climbs from u and from v to the LCA with binary
+// lifting tables that keep the heaviest edge of every 2^k jump, in O(log n). All tables
+// are level-major, so one level is one contiguous array.
+class TreeIndex {
+  public:
+    static constexpr long long UNREACHABLE{-1};
+
+    explicit TreeIndex(const Graph &T, int threads = 0)
+        : n(T.n()), threads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())),
+          component(n, -1), tin(n), preorder(n), depth(n, 0), dist(n, 0) {
+        std::vector<int> parent(n, -1);
+        std::vector<WeightType> parentWeight(n, std::numeric_limits<WeightType>::min());
+        std::vector<int> stack;
+        int next{0};
+        int deepest{0};
+        for (int root{0}; root < n; root++) {
+            if (component[root] != -1)
+                continue;
+
+            component[root] = root;
+            stack.push_back(root);
+            while (!stack.empty()) {
+                int u{stack.back()};
+                stack.pop_back();
+                tin[u] = next;
+                preorder[next++] = u;
+                deepest = std::max(deepest, depth[u]);
+
+                for (const Edge &e : T.E[u]) {
+                    if (component[e.v] != -1)
+                        continue;
+                    component[e.v] = root;
+                    parent[e.v] = u;
+                    parentWeight[e.v] = e.w;
+                    depth[e.v] = depth[u] + 1;
+                    dist[e.v] = dist[u] + e.w;
+                    stack.push_back(e.v);
+                }
+            }
+        }
+
+        // Level 0 of the LCA table; a root keeps its own number, it never lies inside a query range
+        levels = std::max(1, bitWidth(n));
+        sparse.resize(static_cast<size_t>(levels) * n);
+        for (int i{0}; i < n; i++)
+            sparse[i] = parent[preorder[i]] == -1 ? i : tin[parent[preorder[i]]];
+        for (int k{1}; k < levels; k++) {
+            const int *below{sparse.data() + static_cast<size_t>(k - 1) * n};
+            int *level{sparse.data() + static_cast<size_t>(k) * n};
+            int half{1 << (k - 1)};
+            parallelFor(n, this->threads, [&](int lo, int hi) {
+                for (int i{lo}; i < hi; i++)
+                    level[i] = i + half < n ? std::min(below[i], below[i + half]) : below[i];
+            });
+        }
+
+        jumpLevels = std::max(1, bitWidth(deepest));
+        jump.resize(static_cast<size_t>(jumpLevels) * n);
+        jumpMax.resize(static_cast<size_t>(jumpLevels) * n);
+        for (int v{0}; v < n; v++) {
+            jump[v] = parent[v] == -1 ? v : parent[v];
+            jumpMax[v] = parentWeight[v];
+        }
+        for (int k{1}; k < jumpLevels; k++) {
+            const int *below{jump.data() + static_cast<size_t>(k - 1) * n};
+            const WeightType *belowMax{jumpMax.data() + static_cast<size_t>(k - 1) * n};
+            int *level{jump.data() + static_cast<size_t>(k) * n};
+            WeightType *levelMax{jumpMax.data() + static_cast<size_t>(k) * n};
+            parallelFor(n, this->threads, [&](int lo, int hi) {
+                for (int v{lo}; v < hi; v++) {
+                    level[v] = below[below[v]];
+                    levelMax[v] = std::max(belowMax[v], belowMax[below[v]]);
+                }
+            });
+        }
+    }
+
+    int size() const { return n; }
+
+    // Lowest common ancestor, -1 for vertices in different trees
+    int lca(int u, int v) const {
+        if (component[u] != component[v])
+            return -1;
+        if (u == v)
+            return u;
+
+        int lo{std::min(tin[u], tin[v]) + 1};
+        int hi{std::max(tin[u], tin[v]) + 1};
+        int k{bitWidth(hi - lo) - 1};
+        const int *level{sparse.data() + static_cast<size_t>(k) * n};
+        return preorder[std::min(level[lo], level[hi - (1 << k)])];
+    }
+
+    // Sum of the edge weights on the u-v path, UNREACHABLE for different trees
+    long long pathCost(int u, int v) const {
+        int a{lca(u, v)};
+        return a == -1 ? UNREACHABLE : dist[u] + dist[v] - 2 * dist[a];
+    }
+
+    // Heaviest edge on the u-v path, UNREACHABLE for different trees and 0 for u == v
+    long long pathMaxEdge(int u, int v) const {
+        int a{lca(u, v)};
+        if (a == -1)
+            return UNREACHABLE;
+        if (u == v)
+            return 0;
+        return std::max(climb(u, depth[u] - depth[a]), climb(v, depth[v] - depth[a]));
+    }
+
+    // Batch versions, split over the index's threads; out[k] answers pairs[k]
+    void pathCosts(const std::vector<std::pair<int, int>> &pairs, std::vector<long long> &out) const {
+        out.resize(pairs.size());
+        parallelFor(pairs.size(), threads, [&](int lo, int hi) {
+            for (int k{lo}; k < hi; k++)
+                out[k] = pathCost(pairs[k].first, pairs[k].second);
+        });
+    }
+
+    void pathMaxEdges(const std::vector<std::pair<int, int>> &pairs, std::vector<long long> &out) const {
+        out.resize(pairs.size());
+        parallelFor(pairs.size(), threads, [&](int lo, int hi) {
+            for (int k{lo}; k < hi; k++)
+                out[k] = pathMaxEdge(pairs[k].first, pairs[k].second);
+        });
+    }
+
+  private:
+    int n;
+    int threads;
+    int levels;
+    int jumpLevels;
+    std::vector<int> component;
+    std::vector<int> tin;
+    std::vector<int> preorder;
+    std::vector<int> depth;
+    std::vector<long long> dist;
+    std::vector<int> sparse;
+    std::vector<int> jump;
+    std::vector<WeightType> jumpMax;
+
+    // Heaviest edge on the way `steps` edges up from v
+    long long climb(int v, int steps) const {
+        long long heaviest{LLONG_MIN};
+        for (int k{0}; steps > 0; k++, steps >>= 1) {
+            if (steps & 1) {
+                heaviest = std::max<long long>(heaviest, jumpMax[static_cast<size_t>(k) * n + v]);
+                v = jump[static_cast<size_t>(k) * n + v];
+            }
+        }
+        return heaviest;
+    }
+};
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void testPathCost() {
+    std::cout << "=== Path queries on the foreCastLab4 test tree ===\n";
+    Graph T(5);
+    T.add_edge(0, 1, 2);
+    T.add_edge(0, 2, 3);
+    T.add_edge(1, 3, 1);
+    T.add_edge(1, 4, 5);
+
+    TreeIndex index(T);
+    std::cout << "Path cost from 0 to 4: " << index.pathCost(0, 4) << "\n";
+    std::cout << "Expected cost: 7 (0-1-2 + 1-4-5)\n";
+    std::cout << "Path cost from 3 to 2: " << index.pathCost(3, 2) << ", heaviest edge " << index.pathMaxEdge(3, 2) << "\n";
+    std::cout << "Expected cost: 6 (3-1-1 + 1-0-2 + 0-2-3), heaviest edge 3\n";
+}
+
+// Spanning forest of a sparse random graph, then batches of random pairs; the first
+// answers are checked against pathCost
+void benchmark(int n, int queries) {
+    std::mt19937 rng(21);
+    Graph G(n);
+    for (int j{0}; j < 3 * n; j++)
+        G.add_edge(rng() % n, rng() % n, 1 + rng() % 1000);
+    Graph T{primForest(G).first};
+    std::cout << "\n=== Spanning forest of " << n << " vertices, " << T.m() << " edges ===\n";
+
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    TreeIndex index(T);
+    std::cout << "Index build: " << elapsedSince(start) << " ms\n";
+
+    std::vector<std::pair<int, int>> pairs(queries);
+    for (std::pair<int, int> &p : pairs)
+        p = {static_cast<int>(rng() % n), static_cast<int>(rng() % n)};
+
+    std::vector<long long> cost;
+    start = std::chrono::steady_clock::now();
+    index.pathCosts(pairs, cost);
+    double costTime{elapsedSince(start)};
+
+    std::vector<long long> heaviest;
+    start = std::chrono::steady_clock::now();
+    index.pathMaxEdges(pairs, heaviest);
+    double maxTime{elapsedSince(start)};
+
+    const int checked{20};
+    bool agree{true};
+    start = std::chrono::steady_clock::now();
+    for (int q{0}; q < checked; q++) {
+        if (pairs[q].first != pairs[q].second)
+            agree = agree && cost[q] == pathCost(T, pairs[q].first, pairs[q].second);
+    }
+    double baseline{elapsedSince(start)};
+
+    std::cout << queries << " path costs: " << costTime * 1e6 / queries << " ns/query\n";
+    std::cout << queries << " path max edges: " << maxTime * 1e6 / queries << " ns/query\n";
+    std::cout << "pathCost DFS: " << baseline / checked << " ms/query, first " << checked << " answers " << (agree ? "match" : "MISMATCH") << "\n";
+}
+
+int main(int argc, char *argv[]) {
+    testPathCost();
+    benchmark(argc > 1 ? std::atoi(argv[1]) : 1000000, argc > 2 ? std::atoi(argv[2]) : 10000000);
+}